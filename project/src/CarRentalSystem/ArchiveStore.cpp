@@ -0,0 +1,265 @@
+#include "ArchiveStore.h"
+#include <algorithm>
+#ifdef CARRENTAL_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#ifdef CARRENTAL_HAVE_ZLIB
+/**
+ * @brief The text every contract contains. It is the preset dictionary of the compression, so even a single short contract
+ * compresses well. Changing it makes the compressed contracts of the existing segments unreadable.
+ */
+constexpr char CONTRACTDICTIONARY[] = "Contract Details:\nCustomer: \nCar: , License Plate: \nDue Date: \nDue Hours: \nHours of rent: \n"
+	"Total price: Kc\n\nSigned on: \n\nCustomers signutare:.......\nRepresentative signutare:.......";
+
+/**
+ * @brief Compresses the text of a contract.
+ * @return The compressed text, std::nullopt if it could not be compressed.
+ */
+static std::optional<std::string> Deflate(std::string_view text) {
+	z_stream stream = {};
+	if (deflateInit(&stream, Z_BEST_COMPRESSION) != Z_OK) {
+		return std::nullopt;
+	}
+	// A block compressed without the dictionary could not be read back, so the text is stored instead
+	if (deflateSetDictionary(&stream, reinterpret_cast<const Bytef*>(CONTRACTDICTIONARY), sizeof(CONTRACTDICTIONARY) - 1) != Z_OK) {
+		deflateEnd(&stream);
+		return std::nullopt;
+	}
+
+	std::string result(deflateBound(&stream, static_cast<uLong>(text.size())), '\0');
+	stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(text.data()));
+	stream.avail_in = static_cast<uInt>(text.size());
+	stream.next_out = reinterpret_cast<Bytef*>(result.data());
+	stream.avail_out = static_cast<uInt>(result.size());
+	int status = deflate(&stream, Z_FINISH);
+	result.resize(stream.total_out);
+	deflateEnd(&stream);
+	if (status != Z_STREAM_END) {
+		return std::nullopt;
+	}
+	return result;
+}
+
+/**
+ * @brief Decompresses the text of a contract.
+ * @return The text, std::nullopt if the block is damaged.
+ */
+static std::optional<std::string> Inflate(std::string_view block, size_t textSize) {
+	z_stream stream = {};
+	if (inflateInit(&stream) != Z_OK) {
+		return std::nullopt;
+	}
+
+	std::string result(textSize, '\0');
+	stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(block.data()));
+	stream.avail_in = static_cast<uInt>(block.size());
+	stream.next_out = reinterpret_cast<Bytef*>(result.data());
+	stream.avail_out = static_cast<uInt>(result.size());
+	int status = inflate(&stream, Z_FINISH);
+	if (status == Z_NEED_DICT) {
+		status = inflateSetDictionary(&stream, reinterpret_cast<const Bytef*>(CONTRACTDICTIONARY), sizeof(CONTRACTDICTIONARY) - 1);
+		if (status == Z_OK) {
+			status = inflate(&stream, Z_FINISH);
+		}
+	}
+	bool complete = status == Z_STREAM_END && stream.total_out == textSize;
+	inflateEnd(&stream);
+	if (!complete) {
+		return std::nullopt;
+	}
+	return result;
+}
+#endif
+
+bool ArchiveStore::Open(const std::filesystem::path& directory) {
+	Directory = directory;
+	Segments.clear();
+	Positions.clear();
+	Count = 0;
+
+	std::error_code error;
+	std::filesystem::create_directories(Directory, error);
+	if (!std::filesystem::is_directory(Directory, error)) {
+		std::cerr << ERRORMESSAGE << std::endl;
+		return false;
+	}
+
+	for (const auto& entry : std::filesystem::directory_iterator(Directory, error)) {
+		if (entry.path().extension() != ARCHIVEINDEXEXTENSION) {
+			continue;
+		}
+		// A torn entry at the end of an index (from an interrupted append) is not counted
+		size_t count = static_cast<size_t>(entry.file_size(error) / sizeof(ArchiveEntry));
+		if (!error && count != 0) {
+			Segments[entry.path().stem().string()] = count;
+			Count += count;
+		}
+	}
+	return true;
+}
+
+bool ArchiveStore::Add(ContractId id, const ContractRecord& contract, std::string_view text) {
+	ArchiveEntry entry = {};
+	entry.Id = id;
+	entry.Encoding = ArchiveEncoding::Stored;
+	entry.TextSize = static_cast<std::uint32_t>(text.size());
+	entry.Contract = contract;
+
+	std::string block(text);
+#ifdef CARRENTAL_HAVE_ZLIB
+	std::optional<std::string> compressed = Deflate(text);
+	if (compressed && compressed->size() < text.size()) {
+		block = std::move(*compressed);
+		entry.Encoding = ArchiveEncoding::Deflate;
+	}
+#endif
+	entry.StoredSize = static_cast<std::uint32_t>(block.size());
+
+	std::string segment = GetSegmentName(contract.GetDue());
+	std::filesystem::path segmentPath = ConcatPaths(Directory, segment + ARCHIVESEGMENTEXTENSION);
+	std::filesystem::path indexPath = ConcatPaths(Directory, segment + ARCHIVEINDEXEXTENSION);
+
+	std::lock_guard lock(FileWriter::GetFileLock(indexPath));
+	std::error_code error;
+	// The entry goes to the end of the index as it is on disk, a torn entry left there is cut off first
+	std::uintmax_t indexSize = std::filesystem::exists(indexPath, error) ? std::filesystem::file_size(indexPath, error) : 0;
+	if (error) {
+		std::cerr << ERRORMESSAGE << std::endl;
+		return false;
+	}
+	size_t count = static_cast<size_t>(indexSize / sizeof(ArchiveEntry));
+	if (indexSize % sizeof(ArchiveEntry) != 0) {
+		std::filesystem::resize_file(indexPath, count * sizeof(ArchiveEntry), error);
+		if (error) {
+			std::cerr << ERRORMESSAGE << std::endl;
+			return false;
+		}
+	}
+	if (FindEntry(segment, count, id)) {
+		return true;
+	}
+
+	// The block is written before its index entry, so a block without an entry is only unused space
+	entry.Offset = std::filesystem::exists(segmentPath, error) ? std::filesystem::file_size(segmentPath, error) : 0;
+	std::ofstream segmentFile(segmentPath, std::ios_base::binary | std::ios_base::app);
+	if (!segmentFile.is_open() || error) {
+		std::cerr << ERRORMESSAGE << std::endl;
+		return false;
+	}
+	segmentFile.write(block.data(), block.size());
+	segmentFile.close();
+	if (!segmentFile) {
+		return false;
+	}
+
+	std::ofstream indexFile(indexPath, std::ios_base::binary | std::ios_base::app);
+	if (!indexFile.is_open()) {
+		std::cerr << ERRORMESSAGE << std::endl;
+		return false;
+	}
+	indexFile.write(reinterpret_cast<const char*>(&entry), sizeof(entry));
+	if (!indexFile) {
+		return false;
+	}
+
+	// The entries another writer has appended to the index are counted as well
+	size_t& known = Segments[segment];
+	Count += count + 1 - known;
+	known = count + 1;
+	SegmentPositions& positions = Positions[segment];
+	positions.Positions[id] = count;
+	positions.Read = count + 1;
+	return true;
+}
+
+size_t ArchiveStore::GetCount() const {
+	return Count;
+}
+
+std::vector<ArchiveEntry> ArchiveStore::GetPage(size_t page, size_t pageSize) const {
+	std::vector<ArchiveEntry> result;
+	size_t skipped = page * pageSize;
+	for (const auto& [segment, count] : Segments) {
+		if (result.size() == pageSize) {
+			break;
+		}
+		if (skipped >= count) {
+			skipped -= count; // The whole segment is before the page, its index is not read at all
+			continue;
+		}
+
+		// The newest entries are at the end of the index
+		size_t taken = std::min(count - skipped, pageSize - result.size());
+		std::vector<ArchiveEntry> entries = ReadEntries(segment, count - skipped - taken, taken);
+		result.insert(result.end(), entries.rbegin(), entries.rend());
+		skipped = 0;
+	}
+	return result;
+}
+
+std::optional<std::string> ArchiveStore::ReadContract(ContractId id, std::chrono::system_clock::time_point dueDate) const {
+	std::string segment = GetSegmentName(dueDate);
+	auto it = Segments.find(segment);
+	if (it == Segments.end()) {
+		return std::nullopt;
+	}
+
+	std::optional<size_t> position = FindEntry(segment, it->second, id);
+	if (!position) {
+		return std::nullopt;
+	}
+	std::vector<ArchiveEntry> entries = ReadEntries(segment, *position, 1);
+	if (entries.empty() || entries.front().Id != id) {
+		return std::nullopt;
+	}
+	const ArchiveEntry* entry = &entries.front();
+
+	std::ifstream segmentFile(ConcatPaths(Directory, segment + ARCHIVESEGMENTEXTENSION), std::ios_base::binary);
+	std::string block(entry->StoredSize, '\0');
+	segmentFile.seekg(entry->Offset);
+	segmentFile.read(block.data(), block.size());
+	if (!segmentFile) {
+		return std::nullopt;
+	}
+
+	switch (entry->Encoding) {
+	case ArchiveEncoding::Stored:
+		return block;
+	case ArchiveEncoding::Deflate:
+#ifdef CARRENTAL_HAVE_ZLIB
+		return Inflate(block, entry->TextSize);
+#else
+		return std::nullopt; // Written by a build with compression
+#endif
+	}
+	return std::nullopt;
+}
+
+std::string ArchiveStore::GetSegmentName(std::chrono::system_clock::time_point dueDate) {
+	return ContractLedger::FormatTime(dueDate, "%Y_%m");
+}
+
+std::optional<size_t> ArchiveStore::FindEntry(const std::string& segment, size_t count, ContractId id) const {
+	SegmentPositions& positions = Positions[segment];
+	if (positions.Read < count) {
+		std::vector<ArchiveEntry> entries = ReadEntries(segment, positions.Read, count - positions.Read);
+		for (const auto& entry : entries) {
+			positions.Positions[entry.Id] = positions.Read++;
+		}
+	}
+	auto it = positions.Positions.find(id);
+	if (it == positions.Positions.end()) {
+		return std::nullopt;
+	}
+	return it->second;
+}
+
+std::vector<ArchiveEntry> ArchiveStore::ReadEntries(const std::string& segment, size_t first, size_t count) const {
+	std::vector<ArchiveEntry> entries(count);
+	std::ifstream indexFile(ConcatPaths(Directory, segment + ARCHIVEINDEXEXTENSION), std::ios_base::binary);
+	indexFile.seekg(first * sizeof(ArchiveEntry));
+	indexFile.read(reinterpret_cast<char*>(entries.data()), count * sizeof(ArchiveEntry));
+	entries.resize(static_cast<size_t>(indexFile.gcount()) / sizeof(ArchiveEntry));
+	return entries;
+}
@@ -0,0 +1,118 @@
+#pragma once
+
+#ifndef _ARCHIVESTORE_H_
+#define _ARCHIVESTORE_H_
+
+#include <functional>
+#include <map>
+#include <unordered_map>
+#include "ContractLedger.h"
+
+const std::filesystem::path CONTRACTSARCHIVE = "Customers/Contracts/Archive/";
+
+constexpr char ARCHIVESEGMENTEXTENSION[] = ".seg";
+constexpr char ARCHIVEINDEXEXTENSION[] = ".idx";
+
+/**
+ * @brief How the text of an archived contract is stored in its segment.
+ */
+enum class ArchiveEncoding : std::uint32_t { Stored = 0, Deflate = 1 };
+
+/**
+ * @brief The index entry of an archived contract. The index of a segment is an array of these entries,
+ * so the number of contracts in a segment follows from the size of its index.
+ */
+struct ArchiveEntry {
+    ContractId Id;
+    ArchiveEncoding Encoding;
+    std::uint32_t StoredSize; // The size of the block in the segment
+    std::uint32_t TextSize; // The size of the text of the contract
+    std::uint64_t Offset; // The position of the block in the segment
+    ContractRecord Contract;
+};
+
+static_assert(sizeof(ArchiveEntry) == 136, "The archive entry is part of the archive format");
+
+/**
+ * @brief The archived contracts rolled into monthly segments (by their due date). Each segment is a file of the
+ * (compressed) texts of its contracts and a small index of their records and positions in the segment.
+ * Only the names and sizes of the segments are kept in memory, a page of the listing reads just the needed index entries
+ * and a contract is read by seeking into its segment. The positions of the contracts in the index of a segment are read
+ * the first time a contract of the segment is added or read.
+ */
+class ArchiveStore {
+public:
+    /**
+     * @brief Finds the segments of the archive, the directory is created if there is none.
+     * @param directory The directory of the archive.
+     * @return False if the directory could not be read or created.
+     */
+    bool Open(const std::filesystem::path& directory);
+
+    /**
+     * @brief Appends a contract to the segment of the month it was due in. A contract that is already archived
+     * (for example when the ledger could not be written after it was archived) is not appended again.
+     * @param id The identifier of the contract.
+     * @param contract The record of the contract.
+     * @param text The text of the contract.
+     * @return False if the segment could not be written.
+     */
+    bool Add(ContractId id, const ContractRecord& contract, std::string_view text);
+
+    /**
+     * @brief Retrieves the number of archived contracts.
+     */
+    size_t GetCount() const;
+
+    /**
+     * @brief Reads one page of the archived contracts, the latest segment first and the last archived contract of a segment first.
+     * @param page The number of the page, the first page is 0.
+     * @param pageSize The number of contracts on a page.
+     * @return The index entries of the contracts on the page.
+     */
+    std::vector<ArchiveEntry> GetPage(size_t page, size_t pageSize) const;
+
+    /**
+     * @brief Reads the text of an archived contract.
+     * @param id The identifier of the contract.
+     * @param dueDate The due date of the contract, which decides its segment.
+     * @return The text, std::nullopt if the contract is not archived or cannot be read.
+     */
+    std::optional<std::string> ReadContract(ContractId id, std::chrono::system_clock::time_point dueDate) const;
+
+    /**
+     * @brief Decides the name of the segment of a contract (YYYY_MM of the due date in local time).
+     */
+    static std::string GetSegmentName(std::chrono::system_clock::time_point dueDate);
+
+private:
+    /**
+     * @brief Reads the index entries from the given position of a segment.
+     */
+    std::vector<ArchiveEntry> ReadEntries(const std::string& segment, size_t first, size_t count) const;
+
+    /**
+     * @brief Finds the position of a contract in the index of a segment. The entries up to the given count
+     * that have not been read yet are read first.
+     * @param segment The name of the segment.
+     * @param count The number of entries in the index.
+     * @param id The identifier of the contract.
+     * @return The position, std::nullopt if the contract is not in the segment.
+     */
+    std::optional<size_t> FindEntry(const std::string& segment, size_t count, ContractId id) const;
+
+    /**
+     * @brief The positions of the contracts in the index of a segment, the later entry of a contract wins.
+     */
+    struct SegmentPositions {
+        size_t Read = 0; // The number of the entries of the index read so far
+        std::unordered_map<ContractId, size_t> Positions;
+    };
+
+    std::filesystem::path Directory;
+    std::map<std::string, size_t, std::greater<>> Segments; // Segment name -> number of its contracts, the latest segment first
+    size_t Count = 0;
+    mutable std::unordered_map<std::string, SegmentPositions> Positions; // Segment name -> the positions of its contracts
+};
+
+#endif // !_ARCHIVESTORE_H_
@@ -0,0 +1,259 @@
+#include "AuditLog.h"
+#include <algorithm>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include "FileHandler.h"
+
+MpscQueue<AuditEvent> AuditLog::Queue(AUDITQUEUECAPACITY);
+std::atomic<std::uint32_t> AuditLog::Pushed = 0;
+std::atomic<bool> AuditLog::Running = false;
+std::atomic<bool> AuditLog::StopRequested = false;
+std::thread AuditLog::Writer;
+std::filesystem::path AuditLog::Directory;
+std::ofstream AuditLog::File;
+std::uintmax_t AuditLog::FileSize = 0;
+
+constexpr char AUDITFILEPREFIX[] = "audit_";
+constexpr const char* AUDITACTIONNAMES[] = { "LogIn", "CreateContract", "CreateReservation", "ArchiveContract", "MoveCar", "AddCar", "AddCustomer", "AddUser" };
+constexpr const char* AUDITSTATUSNAMES[] = { "Available", "Serviced", "Rented", "PermanentlyUnavailable" };
+
+/**
+ * @brief Reads a null-terminated string from a fixed-width field.
+ */
+static std::string_view GetField(const char* field, size_t size) {
+	return std::string_view(field, strnlen(field, size));
+}
+
+/**
+ * @brief Copies a string into a fixed-width field, a longer string is cut to fit.
+ */
+static void SetField(char* field, size_t size, std::string_view text) {
+	std::memset(field, 0, size);
+	std::memcpy(field, text.data(), std::min(text.size(), size - 1));
+}
+
+static const char* GetStatusName(std::uint8_t status) {
+	return status < std::size(AUDITSTATUSNAMES) ? AUDITSTATUSNAMES[status] : "Unknown";
+}
+
+std::string_view AuditEvent::GetUser() const {
+	return GetField(User, sizeof(User));
+}
+
+std::string_view AuditEvent::GetSubject() const {
+	return GetField(Subject, sizeof(Subject));
+}
+
+std::chrono::system_clock::time_point AuditEvent::GetTime() const {
+	return std::chrono::system_clock::time_point(std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::microseconds(Time)));
+}
+
+bool AuditLog::Start(const std::filesystem::path& directory) {
+	if (Running) {
+		return true;
+	}
+	Directory = directory;
+	std::error_code error;
+	std::filesystem::create_directories(Directory, error);
+	if (!std::filesystem::is_directory(Directory, error)) {
+		std::cerr << ERRORMESSAGE << std::endl;
+		return false;
+	}
+
+	if (!OpenNextFile()) {
+		std::cerr << ERRORMESSAGE << std::endl;
+		return false;
+	}
+
+	StopRequested = false;
+	Running = true;
+	Writer = std::thread(Write);
+	return true;
+}
+
+void AuditLog::Stop() {
+	if (!Running) {
+		return;
+	}
+	StopRequested = true;
+	Pushed.fetch_add(1, std::memory_order_release);
+	Pushed.notify_one();
+	Writer.join();
+	Running = false;
+	File.close();
+}
+
+void AuditLog::Record(AuditAction action, std::string_view user, std::string_view subject, std::uint32_t contract, std::uint8_t from, std::uint8_t to) {
+	if (!Running.load(std::memory_order_relaxed)) {
+		return;
+	}
+	AuditEvent event = {};
+	event.Time = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+	event.Contract = contract;
+	event.Action = action;
+	event.From = from;
+	event.To = to;
+	SetField(event.User, sizeof(event.User), user);
+	SetField(event.Subject, sizeof(event.Subject), subject);
+
+	// The trail must be complete, so a full queue is waited out instead of dropping the event
+	while (!Queue.TryPush(event)) {
+		std::this_thread::yield();
+	}
+	Pushed.fetch_add(1, std::memory_order_release);
+	Pushed.notify_one();
+}
+
+bool AuditLog::ReadFile(const std::filesystem::path& file, std::vector<AuditEvent>& events) {
+	std::ifstream input(file, std::ios_base::binary);
+	AuditHeader header = {};
+	input.read(reinterpret_cast<char*>(&header), sizeof(header));
+	if (!input || std::memcmp(header.Magic, AUDITMAGIC, sizeof(AUDITMAGIC)) != 0 || header.Version != AUDITVERSION
+		|| header.ByteOrder != AUDITBYTEORDER || header.RecordSize != sizeof(AuditEvent)) {
+		return false;
+	}
+
+	AuditEvent event;
+	while (input.read(reinterpret_cast<char*>(&event), sizeof(event))) {
+		events.push_back(event);
+	}
+	return true;
+}
+
+std::vector<std::filesystem::path> AuditLog::GetFiles(const std::filesystem::path& directory) {
+	std::vector<std::filesystem::path> files;
+	std::error_code error;
+	for (const auto& entry : std::filesystem::directory_iterator(directory, error)) {
+		if (entry.path().extension() == AUDITLOGEXTENSION && entry.path().stem().string().starts_with(AUDITFILEPREFIX)) {
+			files.push_back(entry.path());
+		}
+	}
+	std::sort(files.begin(), files.end()); // The numbers have a fixed width, so the names sort by age
+	return files;
+}
+
+std::string AuditLog::Describe(const AuditEvent& event) {
+	std::time_t time = std::chrono::system_clock::to_time_t(event.GetTime());
+	std::tm timeStruct;
+#ifdef _WIN32
+	localtime_s(&timeStruct, &time);
+#else
+	localtime_r(&time, &timeStruct);
+#endif
+	std::ostringstream line;
+	line << std::put_time(&timeStruct, "%Y-%m-%d %H:%M:%S") << '.' << std::setw(6) << std::setfill('0') << ((event.Time % 1000000 + 1000000) % 1000000)
+		<< ' ' << event.GetUser() << ' ';
+	size_t action = static_cast<size_t>(event.Action);
+	line << (action < std::size(AUDITACTIONNAMES) ? AUDITACTIONNAMES[action] : "Unknown") << ' ' << event.GetSubject();
+	if (event.Contract != 0) {
+		line << " contract " << event.Contract;
+	}
+	if (event.From != NOAUDITSTATUS) {
+		line << ' ' << GetStatusName(event.From) << " ->";
+	}
+	if (event.To != NOAUDITSTATUS) {
+		line << ' ' << GetStatusName(event.To);
+	}
+	return line.str();
+}
+
+void AuditLog::Write() {
+#ifndef _WIN32
+	// The signals of the process are left to the other threads, for example the stop signals of the session server
+	sigset_t signals;
+	sigfillset(&signals);
+	pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+#endif
+	std::vector<AuditEvent> batch;
+	batch.reserve(AUDITBATCHSIZE);
+	bool failing = false; // The failure is reported once, not for every try
+	for (;;) {
+		std::uint32_t seen = Pushed.load(std::memory_order_acquire);
+		AuditEvent event;
+		while (batch.size() < AUDITBATCHSIZE && Queue.TryPop(event)) {
+			batch.push_back(event);
+		}
+
+		if (batch.empty()) {
+			if (StopRequested) {
+				return; // Stop is called after the last Record, so nothing can be pushed any more
+			}
+			Pushed.wait(seen, std::memory_order_acquire); // Sleeps until an event is pushed
+			continue;
+		}
+
+		// The batch goes to one file, a new file is started when the current one is full or could not be written
+		if ((!File.is_open() || FileSize >= MAXAUDITFILESIZE) && !OpenNextFile()) {
+			// The trail must be complete, so the batch is kept (and the producers wait once the queue is full) until it is written
+			if (StopRequested) {
+				size_t lost = batch.size();
+				while (Queue.TryPop(event)) {
+					++lost;
+				}
+				std::cerr << AUDITLOSTMESSAGE << ' ' << lost << std::endl;
+				return;
+			}
+			if (!failing) {
+				std::cerr << ERRORMESSAGE << std::endl;
+			}
+			failing = true;
+			std::this_thread::sleep_for(AUDITRETRYINTERVAL);
+			continue;
+		}
+		File.write(reinterpret_cast<const char*>(batch.data()), batch.size() * sizeof(AuditEvent));
+		File.flush();
+		if (!File) {
+			File.close(); // The batch goes to a new file, a part of it may also be at the end of this one
+			continue;
+		}
+		FileSize += batch.size() * sizeof(AuditEvent);
+		failing = false;
+		batch.clear();
+	}
+}
+
+bool AuditLog::OpenNextFile() {
+	File.close();
+	AuditHeader header = {};
+	std::memcpy(header.Magic, AUDITMAGIC, sizeof(AUDITMAGIC));
+	header.Version = AUDITVERSION;
+	header.ByteOrder = AUDITBYTEORDER;
+	header.RecordSize = sizeof(AuditEvent);
+
+	for (size_t attempt = 0; attempt < MAXAUDITFILEATTEMPTS; ++attempt) {
+		unsigned number = 1;
+		std::vector<std::filesystem::path> files = GetFiles(Directory);
+		if (!files.empty()) {
+			std::string stem = files.back().stem().string();
+			number = static_cast<unsigned>(std::strtoul(stem.c_str() + std::strlen(AUDITFILEPREFIX), nullptr, 10)) + 1;
+		}
+		std::ostringstream name;
+		name << AUDITFILEPREFIX << std::setw(6) << std::setfill('0') << number << AUDITLOGEXTENSION;
+		std::filesystem::path path = Directory / name.str();
+
+		// The file is created exclusively ("x"), so a file another process has just created is never truncated or shared
+		std::FILE* created = std::fopen(path.string().c_str(), "wbx");
+		if (created == nullptr) {
+			std::error_code error;
+			if (std::filesystem::exists(path, error)) {
+				continue;
+			}
+			return false;
+		}
+		bool written = std::fwrite(&header, sizeof(header), 1, created) == 1;
+		written = std::fclose(created) == 0 && written;
+		if (!written) {
+			return false;
+		}
+
+		File.open(path, std::ios_base::binary | std::ios_base::app);
+		FileSize = sizeof(header);
+		return File.is_open();
+	}
+	return false;
+}
@@ -0,0 +1,146 @@
+#pragma once
+
+#ifndef _AUDITLOG_H_
+#define _AUDITLOG_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include "MpscQueue.h"
+
+const std::filesystem::path AUDITLOGDIRECTORY = "Audit/";
+
+constexpr char AUDITLOGEXTENSION[] = ".audit";
+constexpr char AUDITMAGIC[8] = { 'C', 'R', 'S', 'A', 'U', 'D', 'I', 'T' };
+constexpr std::uint32_t AUDITVERSION = 1;
+constexpr std::uint32_t AUDITBYTEORDER = 0x01020304; // The log is written in the native byte order and rejected on a machine with another one
+
+constexpr size_t AUDITQUEUECAPACITY = 8192; // The events waiting for the writer, a producer waits only when all of them are taken
+constexpr size_t AUDITBATCHSIZE = 512; // The most events written at once
+constexpr std::uintmax_t MAXAUDITFILESIZE = 4 * 1024 * 1024; // A new file is started when the current one reaches this size
+constexpr char AUDITLOSTMESSAGE[] = "The audit log could not be written, the number of lost events:";
+constexpr size_t MAXAUDITFILEATTEMPTS = 16; // The most names tried when other processes keep taking the next one
+constexpr std::chrono::seconds AUDITRETRYINTERVAL(1); // The wait before a batch that could not be written is tried again
+
+/**
+ * @brief The value of the From and To fields of an event that is not a change of a car status.
+ */
+constexpr std::uint8_t NOAUDITSTATUS = 0xFF;
+
+/**
+ * @brief The audited actions. New actions are added at the end, the values are part of the log format.
+ */
+enum class AuditAction : std::uint8_t { LogIn, CreateContract, CreateReservation, ArchiveContract, MoveCar, AddCar, AddCustomer, AddUser };
+
+/**
+ * @brief The header at the beginning of every log file, followed by the events.
+ */
+struct AuditHeader {
+    char Magic[8];
+    std::uint32_t Version;
+    std::uint32_t ByteOrder;
+    std::uint32_t RecordSize;
+    std::uint32_t Reserved;
+};
+
+/**
+ * @brief An audited action as it is stored in the log. Longer names are cut to fit their fields.
+ */
+struct AuditEvent {
+    std::int64_t Time; // Microseconds since the epoch
+    std::uint32_t Contract; // The contract the action concerns, 0 if none
+    AuditAction Action;
+    std::uint8_t From; // The car status before a move, NOAUDITSTATUS if the action is not a move
+    std::uint8_t To; // The car status after a move or of an added car, NOAUDITSTATUS if none
+    std::uint8_t Reserved;
+    char User[32]; // Null-terminated
+    char Subject[64]; // Null-terminated, the licence plate, customer or user the action concerns
+
+    std::string_view GetUser() const;
+    std::string_view GetSubject() const;
+    std::chrono::system_clock::time_point GetTime() const;
+};
+
+static_assert(sizeof(AuditEvent) == 112, "The audit event is part of the audit log format");
+
+/**
+ * @brief The audit trail of the actions of the users. Recording an action only copies a fixed-size event into a lock-free queue,
+ * a background writer takes the events in batches and appends them to a binary log rotated by size
+ * (audit_000001.audit, audit_000002.audit, ...). The log files are never deleted.
+ * Several processes can log to one directory: a file is created exclusively and only ever written by the process that created it.
+ */
+class AuditLog {
+public:
+    /**
+     * @brief Creates a new log file in the directory and starts the writer. The files of the earlier runs are left as they are,
+     * another process may still be writing them.
+     * @param directory The directory of the log files, it is created if there is none.
+     * @return False if the log cannot be written, the actions are not recorded then.
+     */
+    static bool Start(const std::filesystem::path& directory);
+
+    /**
+     * @brief Writes the remaining events and stops the writer.
+     */
+    static void Stop();
+
+    /**
+     * @brief Records an action. It does nothing if the log is not started.
+     * @param action The action.
+     * @param user The user who performed the action.
+     * @param subject The licence plate, customer or user the action concerns.
+     * @param contract The contract the action concerns, 0 if none.
+     * @param from The car status before a move, NOAUDITSTATUS if none.
+     * @param to The car status after a move or of an added car, NOAUDITSTATUS if none.
+     */
+    static void Record(AuditAction action, std::string_view user, std::string_view subject, std::uint32_t contract = 0,
+        std::uint8_t from = NOAUDITSTATUS, std::uint8_t to = NOAUDITSTATUS);
+
+    /**
+     * @brief Reads the events of a log file.
+     * @param file The log file.
+     * @param events The read events are appended here.
+     * @return False if the file is not an audit log of this machine, a torn event at the end of the file is skipped.
+     */
+    static bool ReadFile(const std::filesystem::path& file, std::vector<AuditEvent>& events);
+
+    /**
+     * @brief Retrieves the log files of a directory, the oldest first.
+     */
+    static std::vector<std::filesystem::path> GetFiles(const std::filesystem::path& directory);
+
+    /**
+     * @brief Describes an event as one line of text.
+     */
+    static std::string Describe(const AuditEvent& event);
+
+private:
+    /**
+     * @brief Takes the events from the queue and writes them until the log is stopped and the queue is empty.
+     */
+    static void Write();
+
+    /**
+     * @brief Creates the log file numbered after the latest file of the directory. When another process creates that file first,
+     * the directory is scanned again.
+     * @return False if no file could be created.
+     */
+    static bool OpenNextFile();
+
+    static MpscQueue<AuditEvent> Queue;
+    static std::atomic<std::uint32_t> Pushed; // Changed after every push, the writer waits for it to change
+    static std::atomic<bool> Running;
+    static std::atomic<bool> StopRequested;
+    static std::thread Writer;
+    static std::filesystem::path Directory;
+    static std::ofstream File; // Only used by the writer
+    static std::uintmax_t FileSize;
+};
+
+#endif // !_AUDITLOG_H_
@@ -0,0 +1,39 @@
+// Decodes the audit log into one line per action, the oldest first.
+// Usage: carrental_audit [log directory or log files...], the log of the build directory is read if none is given
+
+#include "AuditLog.h"
+#include <iostream>
+#include "FileHandler.h"
+
+int main(int argc, char* argv[])
+{
+	std::vector<std::filesystem::path> files;
+	std::vector<std::filesystem::path> arguments(argv + 1, argv + argc);
+	if (arguments.empty()) {
+		arguments.push_back(SOURCEFILES / AUDITLOGDIRECTORY);
+	}
+	for (const std::filesystem::path& argument : arguments) {
+		std::error_code error;
+		if (std::filesystem::is_directory(argument, error)) {
+			std::vector<std::filesystem::path> directoryFiles = AuditLog::GetFiles(argument);
+			files.insert(files.end(), directoryFiles.begin(), directoryFiles.end());
+		}
+		else {
+			files.push_back(argument);
+		}
+	}
+
+	int status = 0;
+	for (const std::filesystem::path& file : files) {
+		std::vector<AuditEvent> events;
+		if (!AuditLog::ReadFile(file, events)) {
+			std::cerr << file.string() << ": not an audit log" << std::endl;
+			status = 1;
+			continue;
+		}
+		for (const AuditEvent& event : events) {
+			std::cout << AuditLog::Describe(event) << '\n';
+		}
+	}
+	return status;
+}
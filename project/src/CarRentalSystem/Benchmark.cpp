@@ -0,0 +1,247 @@
+// Measures the file and repository operations on the data set in the src directory of the current directory (see carrental_datagen)
+// and compares them with a saved baseline.
+// Usage: carrental_bench [--seconds S] [--save-baseline file] [--baseline file] [--threshold percent]
+// The benchmark puts the data set back the way it found it, so the runs stay comparable.
+
+#include "Repository.h"
+#include "LatencyReport.h"
+#include <random>
+#include <iomanip>
+#include <map>
+
+constexpr int DEFAULTSECONDSPEROPERATION = 2;
+constexpr int DEFAULTREGRESSIONTHRESHOLD = 20; // In percent of the median latency or the throughput
+constexpr size_t MINSAMPLES = 5; // Taken even when a single sample takes longer than the time of the operation
+constexpr size_t MAXSAMPLES = 100000;
+constexpr size_t CUSTOMERPHONEPOSITION = 3;
+constexpr char BASELINEHEADER[] = "# carrental_bench baseline: OPERATION SAMPLES OPS_PER_S P50_US P90_US P99_US MAX_US";
+
+/**
+ * @brief The measured latencies (in microseconds) and throughput of one operation.
+ */
+struct OperationResult {
+	std::string Name;
+	double OpsPerSecond = 0;
+	LatencySummary Latencies;
+};
+
+/**
+ * @brief Runs an operation repeatedly until its time is used up and measures every run.
+ * @param name The name of the operation.
+ * @param seconds The time spent measuring (only the operation itself is counted).
+ * @param operation The measured operation.
+ * @param prepare Called before every run, it is not measured.
+ * @param cleanup Called after every run, it is not measured.
+ */
+static OperationResult Measure(const std::string& name, double seconds, const std::function<void()>& operation,
+	const std::function<void()>& prepare = {}, const std::function<void()>& cleanup = {}) {
+	std::vector<double> latencies;
+	double total = 0;
+	while (latencies.size() < MAXSAMPLES && (latencies.size() < MINSAMPLES || total < seconds)) {
+		if (prepare) {
+			prepare();
+		}
+		auto start = std::chrono::steady_clock::now();
+		operation();
+		double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		if (cleanup) {
+			cleanup();
+		}
+		latencies.push_back(elapsed * 1e6);
+		total += elapsed;
+	}
+
+	OperationResult result;
+	result.Name = name;
+	result.OpsPerSecond = total > 0 ? latencies.size() / total : 0;
+	result.Latencies = SummarizeLatencies(latencies);
+	return result;
+}
+
+/**
+ * @brief Retrieves the sizes of the files of the contracts. The ledger and the archive are only appended to,
+ * so cutting them back to these sizes removes the contracts created by the benchmark.
+ */
+static std::map<std::filesystem::path, std::uintmax_t> GetContractFileSizes() {
+	std::map<std::filesystem::path, std::uintmax_t> sizes;
+	std::error_code error;
+	for (const auto& entry : std::filesystem::recursive_directory_iterator(ConcatPaths(SOURCEFILES, CONTRACTSLEDGER).parent_path(), error)) {
+		if (entry.is_regular_file(error)) {
+			sizes[entry.path()] = entry.file_size(error);
+		}
+	}
+	return sizes;
+}
+
+/**
+ * @brief Removes the changes of the benchmark from the data set.
+ * @param contractFileSizes The sizes of the files of the contracts before the benchmark.
+ */
+static void RestoreDataSet(const std::map<std::filesystem::path, std::uintmax_t>& contractFileSizes) {
+	std::error_code error;
+	for (const auto& [path, size] : GetContractFileSizes()) {
+		auto original = contractFileSizes.find(path);
+		if (original == contractFileSizes.end()) {
+			std::filesystem::remove(path, error);
+		}
+		else if (size != original->second) {
+			std::filesystem::resize_file(path, original->second, error);
+		}
+	}
+	// The deleted and moved cars are in the journals of the car files, folding them back leaves the same cars in every file
+	for (size_t i = 0; i < NUMBEROFCARSTATUSES; ++i) {
+		FileWriter::CompactFile(ConcatPaths(SOURCEFILES, GetCarsPath(static_cast<CarStatus>(i))));
+	}
+}
+
+static bool SaveBaseline(const std::filesystem::path& file, const std::vector<OperationResult>& results) {
+	std::ofstream output(file);
+	if (!output.is_open()) {
+		std::cerr << ERRORMESSAGE << std::endl;
+		return false;
+	}
+	output << BASELINEHEADER << '\n';
+	for (const auto& result : results) {
+		const LatencySummary& latencies = result.Latencies;
+		output << result.Name << ' ' << latencies.Samples << ' ' << result.OpsPerSecond << ' ' << latencies.P50 << ' ' << latencies.P90 << ' '
+			<< latencies.P99 << ' ' << latencies.Max << '\n';
+	}
+	return static_cast<bool>(output);
+}
+
+static std::optional<std::vector<OperationResult>> LoadBaseline(const std::filesystem::path& file) {
+	std::ifstream input(file);
+	if (!input.is_open()) {
+		std::cerr << ERRORMESSAGE << std::endl;
+		return std::nullopt;
+	}
+	std::vector<OperationResult> results;
+	std::string line;
+	while (std::getline(input, line)) {
+		if (line.empty() || line[0] == '#') {
+			continue;
+		}
+		OperationResult result;
+		std::istringstream fields(line);
+		LatencySummary& latencies = result.Latencies;
+		if (fields >> result.Name >> latencies.Samples >> result.OpsPerSecond >> latencies.P50 >> latencies.P90 >> latencies.P99 >> latencies.Max) {
+			results.push_back(result);
+		}
+	}
+	return results;
+}
+
+/**
+ * @brief Prints the change of every operation against the baseline.
+ * @return The number of operations whose median latency grew or whose throughput fell by more than the threshold.
+ */
+static size_t CompareWithBaseline(const std::vector<OperationResult>& results, const std::vector<OperationResult>& baseline, int threshold) {
+	auto change = [](double value, double base) { return base > 0 ? (value - base) / base * 100 : 0; };
+
+	size_t regressions = 0;
+	std::cout << std::endl << std::left << std::setw(20) << "OPERATION" << std::right << std::setw(14) << "P50 CHANGE %" << std::setw(14) << "OPS CHANGE %" << std::endl;
+	for (const auto& result : results) {
+		auto base = std::find_if(baseline.begin(), baseline.end(), [&](const OperationResult& base) { return base.Name == result.Name; });
+		if (base == baseline.end()) {
+			std::cout << std::left << std::setw(20) << result.Name << std::right << std::setw(14) << "new" << std::endl;
+			continue;
+		}
+		double latencyChange = change(result.Latencies.P50, base->Latencies.P50);
+		double throughputChange = change(result.OpsPerSecond, base->OpsPerSecond);
+		bool regressed = latencyChange > threshold || throughputChange < -threshold;
+		regressions += regressed;
+		std::cout << std::left << std::setw(20) << result.Name << std::right << std::showpos << std::setw(14) << latencyChange << std::setw(14) << throughputChange
+			<< std::noshowpos << (regressed ? "  REGRESSION" : "") << std::endl;
+	}
+	return regressions;
+}
+
+int main(int argc, char* argv[]) {
+	int seconds = DEFAULTSECONDSPEROPERATION;
+	int threshold = DEFAULTREGRESSIONTHRESHOLD;
+	std::filesystem::path baselineFile;
+	std::filesystem::path savedBaselineFile;
+	for (int i = 1; i < argc; ++i) {
+		std::string option = argv[i];
+		bool hasValue = i + 1 < argc; // Every option takes a value, one without it is invalid
+		if (option == "--seconds" && hasValue && TryParseNumber(argv[i + 1], seconds) && seconds > 0) { ++i; }
+		else if (option == "--threshold" && hasValue && TryParseNumber(argv[i + 1], threshold) && threshold >= 0) { ++i; }
+		else if (option == "--baseline" && hasValue) { baselineFile = argv[++i]; }
+		else if (option == "--save-baseline" && hasValue) { savedBaselineFile = argv[++i]; }
+		else {
+			std::cerr << "Invalid option " << option << std::endl;
+			return 1;
+		}
+	}
+
+	// The keys the operations are run with are picked at random from the data set (without the header lines)
+	StorageVector availableCars = FileReader::GetCars(CarStatus::Available);
+	StorageVector customers = FileReader::GetCustomers();
+	if (availableCars.size() < 2 || customers.size() < 2) {
+		std::cerr << "No data set in " << SOURCEFILES.string() << ", generate one with carrental_datagen" << std::endl;
+		return 1;
+	}
+	availableCars.erase(availableCars.begin());
+	customers.erase(customers.begin());
+	std::mt19937 generator(42);
+	auto pickCar = [&]() -> const Properties& { return availableCars[std::uniform_int_distribution<size_t>(0, availableCars.size() - 1)(generator)]; };
+	auto pickCustomer = [&]() -> const Properties& { return customers[std::uniform_int_distribution<size_t>(0, customers.size() - 1)(generator)]; };
+
+	std::filesystem::path availablePath = ConcatPaths(SOURCEFILES, AVAILABLECARS);
+	std::map<std::filesystem::path, std::uintmax_t> contractFileSizes = GetContractFileSizes();
+	std::vector<OperationResult> results;
+	std::cout << "Available cars: " << availableCars.size() << ", customers: " << customers.size() << std::endl;
+	PrintLatencyHeader(std::cout, "OPERATION", "SAMPLES", true);
+	std::cout << std::fixed << std::setprecision(1);
+	auto run = [&](OperationResult result) {
+		PrintLatencyRow(std::cout, result.Name, result.Latencies, result.OpsPerSecond);
+		results.push_back(std::move(result));
+	};
+
+	// The file operations, before the repository holds the data
+	run(Measure("GetInfo", seconds, [&]() { FileReader::GetCars(CarStatus::Available); }));
+
+	std::string plate;
+	run(Measure("FindRecordByToken", seconds, [&]() { FileReader::FindRecordByToken(availablePath, plate, LICENCEPLATEPOSITION); },
+		[&]() { plate = pickCar()[LICENCEPLATEPOSITION]; }));
+
+	// Every deleted car is added back, so the data set stays the same
+	const Properties* deletedCar = nullptr;
+	run(Measure("DeleteRecordInFile", seconds, [&]() { FileWriter::DeleteRecordInFile(availablePath, (*deletedCar)[LICENCEPLATEPOSITION], LICENCEPLATEPOSITION); },
+		[&]() { deletedCar = &pickCar(); }, [&]() { FileWriter::AddCar(Car(*deletedCar), CarStatus::Available); }));
+
+	run(Measure("Load", seconds, []() { Repository::Load(); }));
+
+	// Every created contract is archived again, so the car is available for the next one
+	std::optional<Car> car;
+	std::optional<Customer> customer;
+	ContractId contract = 0;
+	auto pickContract = [&]() {
+		do {
+			car = Repository::FindCar(CarStatus::Available, pickCar()[LICENCEPLATEPOSITION]);
+		} while (!car);
+		customer = Repository::FindCustomer(pickCustomer()[CUSTOMERPHONEPOSITION]);
+	};
+	auto createContract = [&]() {
+		std::chrono::system_clock::time_point now = std::chrono::system_clock::now();
+		contract = Repository::CreateContract(*customer, *car, now, now + std::chrono::hours(2));
+	};
+	auto archiveContract = [&]() { Repository::ArchiveContract(contract); };
+	run(Measure("CreateContract", seconds, createContract, pickContract, archiveContract));
+	run(Measure("ArchiveContract", seconds, archiveContract, [&]() { pickContract(); createContract(); }));
+
+	run(Measure("CheckContractDates", seconds, []() { Repository::GetDelayedContractsCount(); }));
+	RestoreDataSet(contractFileSizes);
+
+	if (!savedBaselineFile.empty() && !SaveBaseline(savedBaselineFile, results)) {
+		return 1;
+	}
+	if (!baselineFile.empty()) {
+		std::optional<std::vector<OperationResult>> baseline = LoadBaseline(baselineFile);
+		if (!baseline) {
+			return 1;
+		}
+		return CompareWithBaseline(results, *baseline, threshold) == 0 ? 0 : 1;
+	}
+	return 0;
+}
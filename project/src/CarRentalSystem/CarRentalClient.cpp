@@ -0,0 +1,76 @@
+#include "SessionServer.h"
+#include <iostream>
+#include <string>
+#include <cerrno>
+#include <cstring>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+/**
+ * @brief Writes the whole buffer to a descriptor.
+ * @return False if the descriptor is closed.
+ */
+static bool WriteAll(int descriptor, const char* data, size_t size) {
+	while (size > 0) {
+		ssize_t written = write(descriptor, data, size);
+		if (written < 0 && errno == EINTR) {
+			continue;
+		}
+		if (written <= 0) {
+			return false;
+		}
+		data += written;
+		size -= static_cast<size_t>(written);
+	}
+	return true;
+}
+
+// carrental_client [socket], connects the terminal to a session of the server (CarRentalSystem --serve)
+int main(int argc, char* argv[]) {
+	std::string path = argc >= 2 ? argv[1] : DEFAULTSOCKETPATH.string();
+	sockaddr_un address = {};
+	address.sun_family = AF_UNIX;
+	if (path.size() >= sizeof(address.sun_path)) {
+		std::cerr << "The path of the socket is too long." << std::endl;
+		return 1;
+	}
+	std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+
+	int server = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (server < 0 || connect(server, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+		std::cerr << "Cannot connect to the server on " << path << "." << std::endl;
+		return 1;
+	}
+
+	// The input is passed on as it is typed, the session ends when the server closes the connection
+	pollfd descriptors[2] = { { STDIN_FILENO, POLLIN, 0 }, { server, POLLIN, 0 } };
+	char buffer[SOCKETBUFFERSIZE];
+	while (true) {
+		if (poll(descriptors, 2, -1) < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			break;
+		}
+		if (descriptors[1].revents & (POLLIN | POLLHUP | POLLERR)) {
+			ssize_t received = read(server, buffer, sizeof(buffer));
+			if (received <= 0 || !WriteAll(STDOUT_FILENO, buffer, static_cast<size_t>(received))) {
+				break;
+			}
+		}
+		if (descriptors[0].revents & (POLLIN | POLLHUP | POLLERR)) {
+			ssize_t typed = read(STDIN_FILENO, buffer, sizeof(buffer));
+			if (typed <= 0) {
+				shutdown(server, SHUT_WR); // The end of the input ends the session, its last screens are still shown
+				descriptors[0].fd = -1;
+			}
+			else if (!WriteAll(server, buffer, static_cast<size_t>(typed))) {
+				break;
+			}
+		}
+	}
+	close(server);
+	return 0;
+}
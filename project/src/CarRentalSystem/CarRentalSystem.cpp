@@ -2,8 +2,60 @@
 using namespace std;
 
 
-int main()
+int main(int argc, char* argv[])
 {
+	// The actions are recorded by a background writer, so the log is started before the first session and stopped after the last one
+	AuditLog::Start(ConcatPaths(SOURCEFILES, AUDITLOGDIRECTORY));
+	struct AuditStopper {
+		~AuditStopper() { AuditLog::Stop(); }
+	} auditStopper;
+
+	// CarRentalSystem --batch [commands file], the commands are read from the standard input if there is no file
+	if (argc >= 2 && string(argv[1]) == BATCHOPTION) {
+		ifstream commandsFile;
+		if (argc >= 3) {
+			commandsFile.open(argv[2]);
+			if (!commandsFile.is_open()) {
+				cerr << ERRORMESSAGE << endl;
+				return 1;
+			}
+		}
+		System batch(cout, argc >= 3 ? static_cast<istream&>(commandsFile) : cin);
+		return batch.RunBatch() == 0 ? 0 : 1;
+	}
+
+	// CarRentalSystem --record <session file>, the typed lines are saved for carrental_replay
+	if (argc >= 3 && string(argv[1]) == RECORDOPTION) {
+		ofstream recordFile(argv[2], ios_base::binary | ios_base::trunc);
+		if (!recordFile.is_open()) {
+			cerr << ERRORMESSAGE << endl;
+			return 1;
+		}
+		RecordingBuffer recordingBuffer(cin, recordFile);
+		istream recordedInput(&recordingBuffer);
+		System recordedSystem(cout, recordedInput);
+		recordedSystem.Run();
+		return 0;
+	}
+
+#ifdef CARRENTAL_HAVE_SERVER
+	// CarRentalSystem --serve [socket] [workers], the sessions are opened by carrental_client
+	if (argc >= 2 && string(argv[1]) == SERVEOPTION) {
+		size_t workers = DEFAULTSESSIONWORKERS;
+		int parsedWorkers = 0;
+		if (argc >= 4 && TryParseNumber(argv[3], parsedWorkers) && parsedWorkers > 0) {
+			workers = static_cast<size_t>(parsedWorkers);
+		}
+		Repository::Load();
+		SessionServer server(argc >= 3 ? filesystem::path(argv[2]) : DEFAULTSOCKETPATH, workers);
+		if (!server.Start()) {
+			return 1;
+		}
+		server.Run();
+		return 0;
+	}
+#endif
+
 	System CarRentalSystem(cout,cin);
 	CarRentalSystem.Run();
 	return 0;
@@ -4,3 +4,7 @@
 #pragma once
 
 #include "System.h"
+#include "SessionRecorder.h"
+#ifdef CARRENTAL_HAVE_SERVER
+#include "SessionServer.h"
+#endif
@@ -1,135 +1,215 @@
 #include "ConsoleController.h"
 
 void ConsoleController::DisplayMenu(std::ostream& os, const std::vector<std::string>& options, bool inMainMenu, int numberOfDelayedContracts) {
-	DisplayHeader(os);
+	FrameRenderer frame(os);
+
+	DisplayHeader(frame);
 	for (size_t i = 0; i < options.size(); ++i) {
-		DisplayMenuOption(std::to_string(i + 1) + "." + options[i], os);
+		DisplayMenuOption(std::to_string(i + 1) + "." + options[i], frame);
 	}
-	DisplayFooter(os, inMainMenu, numberOfDelayedContracts);
+	DisplayFooter(frame, inMainMenu, numberOfDelayedContracts);
 
 }
 
-void ConsoleController::DisplayCars(std::ostream& os, CarStatus status) {
-	DisplayHeader(os);
+size_t ConsoleController::DisplayCars(std::ostream& os, CarStatus status, size_t page) {
+	FrameRenderer frame(os);
+
+	DisplayHeader(frame);
 
 	switch (status) {
 	case Available:
-		DisplayContentHeader(os, "Available cars");
-		DisplayContent(os, FileReader::GetCars(CarStatus::Available));
+		DisplayContentHeader(frame, "Available cars");
 		break;
 	case Serviced:
-		DisplayContentHeader(os, "Serviced cars");
-		DisplayContent(os, FileReader::GetCars(CarStatus::Serviced));
+		DisplayContentHeader(frame, "Serviced cars");
 		break;
 	case Rented:
-		DisplayContentHeader(os, "Rented cars");
-		DisplayContent(os, FileReader::GetCars(CarStatus::Rented));
+		DisplayContentHeader(frame, "Rented cars");
 		break;
 	case PermanentlyUnavailable:
-		DisplayContentHeader(os, "Permanently unavailable cars");
-		DisplayContent(os, FileReader::GetCars(CarStatus::PermanentlyUnavailable));
+		DisplayContentHeader(frame, "Permanently unavailable cars");
 		break;
 	}
+	ContentPage content = Repository::GetCarsPage(status, page);
+	DisplayContent(frame, content);
+
+	DisplayFooter(frame);
+	return content.PageCount;
+}
+
+size_t ConsoleController::DisplayCustomers(std::ostream& os, size_t page) {
+	FrameRenderer frame(os);
+
+	DisplayHeader(frame);
+
+	DisplayContentHeader(frame, "Customers");
+
+	ContentPage content = Repository::GetCustomersPage(page);
+	DisplayContent(frame, content);
+
+	DisplayFooter(frame);
+	return content.PageCount;
+}
+
+size_t ConsoleController::DisplayActiveContracts(std::ostream& os, size_t page) {
+	FrameRenderer frame(os);
+
+	DisplayHeader(frame);
+
+	DisplayContentHeader(frame, "Active contracts");
+
+	ContentPage content = Repository::GetActiveContracts(page);
+	DisplayContent(frame, content);
+
+	std::vector<DueContract> dueNext = Repository::GetContractsDueNext(NEXTDUECONTRACTS);
+	if (!dueNext.empty()) {
+		frame << '\n';
+		DisplayContentHeader(frame, "Due next");
+		StorageVector rows;
+		for (const auto& [dueDate, id] : dueNext) {
+			rows.push_back({ std::to_string(id), ContractLedger::FormatTime(dueDate, "%d. %m. %Y %H:%M") });
+		}
+		DisplayContent(frame, rows, true);
+	}
+
+	DisplayFooter(frame);
+	return content.PageCount;
+}
+
+size_t ConsoleController::DisplayArchivedContracts(std::ostream& os, size_t page) {
+	FrameRenderer frame(os);
+
+	DisplayHeader(frame);
 
-	DisplayFooter(os);
+	DisplayContentHeader(frame, "Archived contracts");
+
+	ContentPage content = Repository::GetArchivedContracts(page);
+	DisplayContent(frame, content);
+
+	DisplayFooter(frame);
+	return content.PageCount;
 }
 
-void ConsoleController::DisplayCustomers(std::ostream& os) {
-	DisplayHeader(os);
+size_t ConsoleController::DisplayListing(std::ostream& os, const std::string& title, const StorageVector& content, size_t page) {
+	FrameRenderer frame(os);
+
+	DisplayHeader(frame);
 
-	DisplayContentHeader(os, "Customers");
+	DisplayContentHeader(frame, title);
 
-	DisplayContent(os, FileReader::GetCustomers());
+	ContentPage contentPage = Repository::Paginate(content, page);
+	DisplayContent(frame, contentPage);
 
-	DisplayFooter(os);
+	DisplayFooter(frame);
+	return contentPage.PageCount;
 }
 
-void ConsoleController::DisplayActiveContracts(std::ostream& os) {
-	DisplayHeader(os);
+size_t ConsoleController::DisplayReports(std::ostream& os, const ReadView& view, const StorageVector& months, size_t page) {
+	FrameRenderer frame(os);
 
-	DisplayContentHeader(os, "Active contracts");
+	DisplayHeader(frame);
 
-	DisplayContent(os, FileReader::GetActiveContracs(), true);
+	DisplayContentHeader(frame, "Rental as of " + ContractLedger::FormatTime(view.Taken, "%d. %m. %Y %H:%M"));
+	DisplayContent(frame, Reports::SummarizeRental(view));
 
-	DisplayFooter(os);
+	frame << '\n';
+	DisplayContentHeader(frame, "Best customers");
+	DisplayContent(frame, Reports::FindTopCustomers(view, TOPCUSTOMERS));
+
+	frame << '\n';
+	DisplayContentHeader(frame, "Contracts by the month they started");
+	ContentPage monthsPage = Repository::Paginate(months, page);
+	DisplayContent(frame, monthsPage);
+
+	DisplayFooter(frame);
+	return monthsPage.PageCount;
 }
 
-void ConsoleController::DisplayArchivedContracts(std::ostream& os) {
-	DisplayHeader(os);
+void ConsoleController::DisplayContract(std::ostream& os, ContractId id) {
+	FrameRenderer frame(os);
 
-	DisplayContentHeader(os, "Archived contracts");
+	DisplayHeader(frame);
 
-	DisplayContent(os, FileReader::GetArchivedContracs(), true);
+	DisplayContentHeader(frame, "Contract " + std::to_string(id));
+	frame << '\n';
+	for (const auto& line : Repository::RenderContract(id)) {
+		frame << Padding(SAFEINDENTATIONRATIO * SPACING) << line << '\n';
+	}
 
-	DisplayFooter(os);
+	DisplayFooter(frame);
 }
 
 void ConsoleController::DisplayAddingMessage(std::ostream& os, const std::string namesOfColumns) {
-	DisplayHeader(os);
+	FrameRenderer frame(os);
 
-	os << std::string(CalculateSpacing(strlen(ADDINGNEWRECORDSMESSAGE1)), ' ') << ADDINGNEWRECORDSMESSAGE1 << std::endl;
-	os << std::string(CalculateSpacing(strlen(ADDINGNEWRECORDSMESSAGE2)), ' ') << ADDINGNEWRECORDSMESSAGE2 << std::endl;
-	os << std::string(CalculateSpacing(namesOfColumns.length()), ' ') << namesOfColumns << std::endl;
+	DisplayHeader(frame);
 
-	DisplayFooter(os);
+	frame << Padding(CalculateSpacing(strlen(ADDINGNEWRECORDSMESSAGE1))) << ADDINGNEWRECORDSMESSAGE1 << '\n';
+	frame << Padding(CalculateSpacing(strlen(ADDINGNEWRECORDSMESSAGE2))) << ADDINGNEWRECORDSMESSAGE2 << '\n';
+	frame << Padding(CalculateSpacing(namesOfColumns.length())) << namesOfColumns << '\n';
+
+	DisplayFooter(frame);
 }
 
 void ConsoleController::ClearConsole() {
-#ifdef _WIN32
-	std::system("cls");
-#else
-	std::system("clear");
-#endif
+	FrameRenderer::RequestClear();
 }
 
 void ConsoleController::PrintMessage(std::ostream& os, const std::string& message) {
-	os << message << std::endl;
+	FrameRenderer frame(os);
+
+	frame << message << '\n';
 }
 
 void ConsoleController::PrintIncorrectMessage(std::ostream& os, const std::string& what) {
-	os << what << " is incorrect, try again. Or type CANCEL to cancel." << std::endl;
+	FrameRenderer frame(os);
+
+	frame << what << " is incorrect, try again. Or type CANCEL to cancel.\n";
 }
 
 void ConsoleController::PrintPromptMessage(std::ostream& os, const std::string& what, const std::string& info) {
+	FrameRenderer frame(os);
+
 	std::string possessivePronoun = "its";
 	if (what == "customer") { possessivePronoun = "their"; }
-	os << "Please choose a " << what << ", write " << possessivePronoun << " " << info << " here : " << std::endl;
+	frame << "Please choose a " << what << ", write " << possessivePronoun << " " << info << " here : \n";
 }
 
 void ConsoleController::DisplayGoodByeMessage(std::ostream& os) {
+	FrameRenderer frame(os);
+
 	for (size_t i = 0; i < BORDERWIDTH; ++i) {
-		os << std::string(WIDTH, BORDERCHAR) << std::endl;
+		frame << Padding(WIDTH, BORDERCHAR) << '\n';
 	}
 	for (size_t i = 0; i < SPACING; ++i) {
-		os << std::endl;
+		frame << '\n';
 	}
 
 	int spacing = WIDTH / SAFEINDENTATIONRATIO;
 
 
 	// Display bye bye man
-	os << "	     /" << std::endl;
-	os << "	   O/ " << std::endl;
-	os << "	  /|  " << std::endl;
-	os << "	 / |  " << std::string(spacing, ' ') << GOODBYEMESSAGE << std::string(spacing, ' ') << std::endl;
-	os << "	   |  " << std::endl;
-	os << "	  / \\ " << std::endl;
-	os << "	 /   \\" << std::endl;
+	frame << "	     /" << '\n';
+	frame << "	   O/ " << '\n';
+	frame << "	  /|  " << '\n';
+	frame << "	 / |  " << Padding(spacing) << GOODBYEMESSAGE << Padding(spacing) << '\n';
+	frame << "	   |  " << '\n';
+	frame << "	  / \\ " << '\n';
+	frame << "	 /   \\" << '\n';
 
 	for (size_t i = 0; i < SPACING; ++i) {
-		os << std::endl;
+		frame << '\n';
 	}
 	for (size_t i = 0; i < BORDERWIDTH; ++i) {
-		os << std::string(WIDTH, BORDERCHAR) << std::endl;
+		frame << Padding(WIDTH, BORDERCHAR) << '\n';
 	}
 }
 
 int ConsoleController::GetIntInput(std::ostream& os, std::istream& is, int min, int max) {
 	std::string inputOption;
 	while (true) {
-		is >> inputOption;
-
-		if (inputOption == "CANCEL") {
+		// The end of the input (e.g. a closed session) cancels like CANCEL
+		if (!(is >> inputOption) || inputOption == "CANCEL") {
 			return -1;
 		}
 
@@ -157,76 +237,95 @@ int ConsoleController::GetIntInput(std::ostream& os, std::istream& is, int min,
 
 std::string ConsoleController::GetStringInput(std::istream& is) {
 	std::string inputOption;
-	std::getline(is, inputOption);
+	if (!std::getline(is, inputOption)) {
+		return "CANCEL"; // The end of the input
+	}
 	return inputOption;
 }
 
 void ConsoleController::DisplayContent(std::ostream& os, const std::vector<std::vector<std::string>>& content, bool displayFileNames) {
-	std::vector<size_t> maxSizes;
 	if ((!displayFileNames && content.size() == 1) || (displayFileNames && content.size() == 0)) {
-		os << std::endl << std::string(CalculateSpacing(strlen(EMPTYMESSAGE)), ' ') << EMPTYMESSAGE << std::endl;
+		os << '\n' << Padding(CalculateSpacing(strlen(EMPTYMESSAGE))) << EMPTYMESSAGE << '\n';
+		return;
+	}
+	DisplayRows(os, content, MeasureColumns(content));
+}
+
+void ConsoleController::DisplayContent(std::ostream& os, const ContentPage& page) {
+	if (page.Rows.size() <= 1) {
+		os << '\n' << Padding(CalculateSpacing(strlen(EMPTYMESSAGE))) << EMPTYMESSAGE << '\n';
 		return;
 	}
-	for (size_t i = 0; i < content[0].size(); ++i) {
-		maxSizes.push_back(0);
+	DisplayRows(os, page.Rows, page.ColumnWidths.empty() ? MeasureColumns(page.Rows) : page.ColumnWidths);
+	if (page.PageCount > 1) {
+		os << '\n';
+		DisplayContentHeader(os, "Page " + std::to_string(page.Page + 1) + " of " + std::to_string(page.PageCount));
 	}
-	size_t maxTotalSize = 0;
-	for (auto&& line : content) {
-		size_t totalSize = 0;
-		for (size_t i = 0; i < line.size(); ++i) {
-			if (line[i].size() > maxSizes[i]) {
-				maxSizes[i] = line[i].size();
-			}
-			totalSize += line[i].size();
-		}
-		if (totalSize > maxTotalSize) {
-			maxTotalSize = totalSize;
-		}
+}
+
+void ConsoleController::DisplayRows(std::ostream& os, const StorageVector& rows, const std::vector<size_t>& widths) {
+	size_t totalWidth = widths.empty() ? 0 : widths.size() - 1; // The spaces between the columns
+	for (size_t width : widths) {
+		totalWidth += width;
 	}
-	size_t spacing = CalculateSpacing(maxTotalSize + content[0].size() - 1);
-	for (size_t x = 0; x < content.size(); ++x) {
-		os  << std::string(CalculateSpacing(maxTotalSize + content[0].size() - 1), ' ');
-		for (size_t i = 0; i < content[x].size(); ++i) {
-			os << content[x][i] << std::string(maxSizes[i] - content[x][i].size(), ' ');
-			if (i < content[x].size() - 1) {
+	size_t spacing = CalculateSpacing(totalWidth);
+	for (const auto& row : rows) {
+		os << Padding(spacing);
+		for (size_t i = 0; i < row.size(); ++i) {
+			size_t width = i < widths.size() ? widths[i] : 0;
+			os << row[i] << Padding(width > row[i].size() ? width - row[i].size() : 0);
+			if (i < row.size() - 1) {
 				os << ' ';
 			}
 		}
-		os << std::string(spacing, ' ') << std::endl;
+		os << Padding(spacing) << '\n';
+	}
+}
+
+std::vector<size_t> ConsoleController::MeasureColumns(const StorageVector& rows) {
+	std::vector<size_t> widths;
+	for (const auto& row : rows) {
+		widths.resize(std::max(widths.size(), row.size()));
+		for (size_t i = 0; i < row.size(); ++i) {
+			widths[i] = std::max(widths[i], row[i].size());
+		}
 	}
+	return widths;
 }
 
 void ConsoleController::DisplayContentHeader(std::ostream& os, const std::string& title) {
 	size_t spacing = CalculateSpacing(title.size());
-	os << std::string(spacing, ' ') << title << std::endl;
+	os << Padding(spacing) << title << '\n';
 }
 
 void ConsoleController::DisplayLogInMenu(std::ostream& os) {
-	DisplayHeader(os);
+	FrameRenderer frame(os);
+
+	DisplayHeader(frame);
 
-	std::cout << std::string(CalculateSpacing(strlen(WELCOMEMESSAGE)), ' ') << WELCOMEMESSAGE << std::string(CalculateSpacing(strlen(WELCOMEMESSAGE)), ' ') << std::endl;
+	frame << Padding(CalculateSpacing(strlen(WELCOMEMESSAGE))) << WELCOMEMESSAGE << Padding(CalculateSpacing(strlen(WELCOMEMESSAGE))) << '\n';
 	
-	DisplayFooter(os, false, 0, true);
+	DisplayFooter(frame, false, 0, true);
 }
 
 void ConsoleController::DisplayHeader(std::ostream& os) {
 	for (size_t i = 0; i < BORDERWIDTH; ++i) {
-		os << std::string(WIDTH, BORDERCHAR) << std::endl;
+		os << Padding(WIDTH, BORDERCHAR) << '\n';
 	}
 	for (size_t i = 0; i < SPACING; ++i) {
-		os << std::endl;
+		os << '\n';
 	}
-	os << std::string(CalculateSpacing(strlen(NAME)), ' ') << NAME << std::endl << std::endl;
+	os << Padding(CalculateSpacing(strlen(NAME))) << NAME << '\n' << '\n';
 }
 
 void ConsoleController::DisplayFooter(std::ostream& os, bool inMainMenu, int numberOfDelayedContracts, bool showExitOption) {
 	for (size_t i = 0; i < SPACING; ++i) {
-		os << std::endl;
+		os << '\n';
 	}
 	if(showExitOption){}
 	else if (inMainMenu) {
 		if (numberOfDelayedContracts == 0) {
-			os << EXITOPTIONLINE << std::endl;
+			os << EXITOPTIONLINE << '\n';
 		}
 		else {
 			std::ostringstream oss;
@@ -242,22 +341,22 @@ void ConsoleController::DisplayFooter(std::ostream& os, bool inMainMenu, int num
 			if (spacing <= 0) {
 				spacing = SAFEINDENTATIONRATIO;
 			}
-			os << EXITOPTIONLINE << std::string(spacing, ' ') << delayedContractsMessage << std::endl;
+			os << EXITOPTIONLINE << Padding(spacing) << delayedContractsMessage << '\n';
 		}
 	}
 	else {
-		os << BACKOPTIONLINE << std::endl;
+		os << BACKOPTIONLINE << '\n';
 	}
 	for (size_t i = 0; i < BORDERWIDTH; ++i) {
-		os << std::string(WIDTH, BORDERCHAR) << std::endl;
+		os << Padding(WIDTH, BORDERCHAR) << '\n';
 	}
 }
 
 void ConsoleController::DisplayMenuOption(const std::string& option, std::ostream& os) {
 	size_t spacing = CalculateSpacing(option.length());
-	os  << std::string(spacing, ' ')
-		<< option << std::string(spacing, ' ')
-		<< std::endl;
+	os  << Padding(spacing)
+		<< option << Padding(spacing)
+		<< '\n';
 }
 
 size_t ConsoleController::CalculateSpacing(size_t lengthOfContent){
@@ -5,7 +5,9 @@
 #ifndef _CONSOLECONTROLLER_H_
 #define _CONSOLECONTROLLER_H_
 
-#include "FileHandler.h"
+#include "Repository.h"
+#include "FrameRenderer.h"
+#include "Reports.h"
 #include <ostream>
 #include <algorithm>
 #include <cstring>
@@ -18,15 +20,24 @@ constexpr short BORDERWIDTH = 1;
 constexpr short SPACING = 2;
 constexpr short SAFEINDENTATIONRATIO = 4;
 
-constexpr char CARSCOLUMNSNAMES[] = "MAKE MODEL YEAR COLOR LICENCE_PLATE MOTORIZATION GEARBOX SEATS COST_PER_HOUR";
-constexpr char CUSTOMERSCOLUMNSNAMES[] = "NAME SURNAME EMAIL PHONE ADRESS";
-constexpr char USERCOLUMNSNAMES[] = "USERNAME PASSWORD ADMIN_STATUS";
+// The column lists of the records are generated from their schemas
+constexpr auto CARSCOLUMNSNAMES = ColumnNames<Car>();
+constexpr auto CUSTOMERSCOLUMNSNAMES = ColumnNames<Customer>();
+constexpr auto USERCOLUMNSNAMES = ColumnNames<User>();
 constexpr char DATECOLUMNSNAMES[] = "YEAR MONTH DAY HOUR MINUTES";
 constexpr char ADDINGNEWRECORDSMESSAGE1[] = "Please provide us with the following information in the correct order.";
 constexpr char ADDINGNEWRECORDSMESSAGE2[] = "Or type CANCEL to cancel and return to main menu.";
 constexpr char NAME[] = "Car rental system";
 constexpr char BACKOPTIONLINE[] = "0. Back to main menu";
 constexpr char EXITOPTIONLINE[] = "0. Exit";
+constexpr char BOOKEDCARMESSAGE[] = "The contract was not created, the car is already booked in that period.";
+constexpr char INVALIDPERIODMESSAGE[] = "The reservation has to end after it starts.";
+constexpr char INVALIDDATEMESSAGE[] = "The contract was not created, the date cannot be used.";
+constexpr char PASTDUEDATEMESSAGE[] = "The contract was not created, the due date has to be in the future.";
+constexpr char INVALIDSEARCHMESSAGE[] = "Nothing was searched, check the numbers and the order.";
+constexpr char DUPLICATECARMESSAGE[] = "The car was not added, there already is a car with this licence plate.";
+constexpr char DUPLICATECUSTOMERMESSAGE[] = "The customer was not added, there already is a customer with this phone number or e-mail.";
+constexpr char INVALIDCARMESSAGE[] = "The car was not added, check the numbers and the length of the licence plate.";
 constexpr char EMPTYMESSAGE[] = "There is nothing here.";
 constexpr char WELCOMEMESSAGE[] = "Welcome! You can now log in.";
 constexpr char GOODBYEMESSAGE[] = "Thank you for working with us! Have a great day!";
@@ -46,29 +57,64 @@ public:
     static void DisplayMenu(std::ostream& os, const std::vector<std::string>& options, bool inMainMenu, int numberOfDelayedContracts = 0);
 
     /**
-     * @brief Displays the list of chosen cars.
+     * @brief Displays one page of the list of chosen cars.
      * @param os The output stream to display the available cars.
      * @param status status of cars we want to display
+     * @param page The number of the page, the first page is 0.
+     * @return The number of pages.
      */
-    static void DisplayCars(std::ostream& os, CarStatus status);
+    static size_t DisplayCars(std::ostream& os, CarStatus status, size_t page = 0);
 
     /**
-     * @brief Displays the list of customers.
+     * @brief Displays one page of the list of customers.
      * @param os The output stream to display the customers.
+     * @param page The number of the page, the first page is 0.
+     * @return The number of pages.
      */
-    static void DisplayCustomers(std::ostream& os);
+    static size_t DisplayCustomers(std::ostream& os, size_t page = 0);
 
     /**
-     * @brief Displays the list of active contracts.
+     * @brief Displays one page of the list of active contracts and the contracts due next.
      * @param os The output stream to display the active contracts.
+     * @param page The number of the page, the first page is 0.
+     * @return The number of pages.
      */
-    static void DisplayActiveContracts(std::ostream& os);
+    static size_t DisplayActiveContracts(std::ostream& os, size_t page = 0);
 
     /**
-     * @brief Displays the list of archived contracts.
+     * @brief Displays one page of the archived contracts.
      * @param os The output stream to display the archived contracts.
+     * @param page The number of the page, the first page is 0.
+     * @return The number of pages.
      */
-    static void DisplayArchivedContracts(std::ostream& os);
+    static size_t DisplayArchivedContracts(std::ostream& os, size_t page = 0);
+
+    /**
+     * @brief Displays the text of a contract.
+     * @param os The output stream to display the contract.
+     * @param id The identifier of the contract.
+     */
+    static void DisplayContract(std::ostream& os, ContractId id);
+
+    /**
+     * @brief Displays one page of a list of records, for example the result of a search.
+     * @param os The output stream to display the records.
+     * @param title The title of the list.
+     * @param content The records, the first row is the header.
+     * @param page The number of the page, the first page is 0.
+     * @return The number of pages.
+     */
+    static size_t DisplayListing(std::ostream& os, const std::string& title, const StorageVector& content, size_t page = 0);
+
+    /**
+     * @brief Displays the reports of the rental computed from one read view and one page of the months.
+     * @param os The output stream to display the reports.
+     * @param view The view the reports are computed from.
+     * @param months The contracts summed by months (see Reports::SummarizeMonths).
+     * @param page The number of the page of the months, the first page is 0.
+     * @return The number of pages of the months.
+     */
+    static size_t DisplayReports(std::ostream& os, const ReadView& view, const StorageVector& months, size_t page = 0);
 
     /**
      * @brief Displays a goodbye message.
@@ -90,7 +136,7 @@ public:
     static void DisplayLogInMenu(std::ostream& os);
 
     /**
-     * @brief Clears the console.
+     * @brief Clears the console, the escape sequence is written with the next screen so that both are shown at once.
      */
     static void ClearConsole();
 
@@ -125,14 +171,14 @@ public:
      * @param is The input stream to get the user's input.
      * @param min The minimum valid value.
      * @param max The maximum valid value.
-     * @return The integer input from the user.
+     * @return The integer input from the user, -1 if the user typed CANCEL or the input ended.
      */
     static int GetIntInput(std::ostream& os, std::istream& is, int min, int max);
 
     /**
      * @brief Gets a string input from the user.
      * @param is The input stream to get the user's input.
-     * @return The string input from the user.
+     * @return The string input from the user, CANCEL if the input ended.
      */
     static std::string GetStringInput(std::istream& is);
 
@@ -145,6 +191,25 @@ private:
      */
     static void DisplayContent(std::ostream& os, const std::vector<std::vector<std::string>>& content, bool displayFileNames = false);
 
+    /**
+     * @brief Displays one page of a list of records and the number of the page.
+     * @param os The output stream to display the content.
+     * @param page The page, its columns are measured only if it has no widths of the columns.
+     */
+    static void DisplayContent(std::ostream& os, const ContentPage& page);
+
+    /**
+     * @brief Displays rows of records aligned in columns.
+     * @param os The output stream to display the rows.
+     * @param rows The rows to display.
+     * @param widths The widths of the columns.
+     */
+    static void DisplayRows(std::ostream& os, const StorageVector& rows, const std::vector<size_t>& widths);
+
+    /**
+     * @brief Measures the widths of the columns of the given rows.
+     */
+    static std::vector<size_t> MeasureColumns(const StorageVector& rows);
     /**
      * @brief Displays the header for a content section.
      * @param os The output stream to display the header.
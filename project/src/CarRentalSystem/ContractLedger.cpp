@@ -0,0 +1,246 @@
+#include "ContractLedger.h"
+#include <cstring>
+#include <iomanip>
+
+/**
+ * @brief Reads a null-terminated string from a fixed-width field.
+ */
+static std::string_view GetField(const char* field, size_t size) {
+	return std::string_view(field, strnlen(field, size));
+}
+
+/**
+ * @brief Copies a string into a fixed-width field, the rest of the field is filled with null characters.
+ * @return False if the string (with its null character) does not fit.
+ */
+static bool SetField(char* field, size_t size, std::string_view text) {
+	if (text.size() >= size) {
+		return false;
+	}
+	std::memset(field, 0, size);
+	std::memcpy(field, text.data(), text.size());
+	return true;
+}
+
+std::string_view ContractRecord::GetCustomer() const {
+	return GetField(Customer, sizeof(Customer));
+}
+
+std::string_view ContractRecord::GetLicencePlate() const {
+	return GetField(LicencePlate, sizeof(LicencePlate));
+}
+
+std::chrono::system_clock::time_point ContractRecord::GetStart() const {
+	return std::chrono::system_clock::time_point(std::chrono::seconds(Start));
+}
+
+std::chrono::system_clock::time_point ContractRecord::GetDue() const {
+	return std::chrono::system_clock::time_point(std::chrono::seconds(Due));
+}
+
+ContractState ContractRecord::GetState() const {
+	return State == static_cast<std::uint8_t>(ContractState::Archived) ? ContractState::Archived : ContractState::Active;
+}
+
+bool ContractLedger::Open(const std::filesystem::path& ledger) {
+	Path = ledger;
+	Records.clear();
+	Valid = false;
+
+	// An empty ledger (for example one whose creation was interrupted) is created again, file_size does not return 0 on an error
+	std::error_code error;
+	if (!std::filesystem::exists(Path, error) || std::filesystem::file_size(Path, error) == 0) {
+		LedgerHeader header = {};
+		std::memcpy(header.Magic, LEDGERMAGIC, sizeof(LEDGERMAGIC));
+		header.Version = LEDGERVERSION;
+		header.ByteOrder = LEDGERBYTEORDER;
+		header.RecordSize = sizeof(ContractRecord);
+
+		std::ofstream outputFile(Path, std::ios_base::binary);
+		if (!outputFile.is_open()) {
+			std::cerr << ERRORMESSAGE << std::endl;
+			return false;
+		}
+		outputFile.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		Valid = static_cast<bool>(outputFile);
+		return Valid;
+	}
+
+	size_t validSize = 0;
+	bool torn = false;
+	{
+		MappedFile file(Path);
+		std::string_view content = file.GetContent();
+		LedgerHeader header = {};
+		if (!file.IsOpen() || content.size() < sizeof(header)) {
+			std::cerr << ERRORMESSAGE << std::endl;
+			return false;
+		}
+		std::memcpy(&header, content.data(), sizeof(header));
+		if (std::memcmp(header.Magic, LEDGERMAGIC, sizeof(LEDGERMAGIC)) != 0 || header.Version != LEDGERVERSION
+			|| header.ByteOrder != LEDGERBYTEORDER || header.RecordSize != sizeof(ContractRecord)) {
+			std::cerr << ERRORMESSAGE << std::endl;
+			return false;
+		}
+
+		size_t count = (content.size() - sizeof(header)) / sizeof(ContractRecord);
+		Records.resize(count);
+		std::memcpy(Records.data(), content.data() + sizeof(header), count * sizeof(ContractRecord));
+		validSize = sizeof(header) + count * sizeof(ContractRecord);
+		torn = validSize != content.size();
+	}
+
+	// The mapping is closed by now, so the torn record can be cut off
+	if (torn) {
+		std::filesystem::resize_file(Path, validSize, error);
+	}
+	Valid = true;
+	return true;
+}
+
+ContractId ContractLedger::Append(const ContractRecord& record) {
+	if (!Valid) {
+		std::cerr << ERRORMESSAGE << std::endl;
+		return 0;
+	}
+	std::lock_guard lock(FileWriter::GetFileLock(Path));
+	std::error_code error;
+	std::uintmax_t size = std::filesystem::file_size(Path, error);
+	if (error || size < sizeof(LedgerHeader) || (size - sizeof(LedgerHeader)) % sizeof(ContractRecord) != 0) {
+		std::cerr << ERRORMESSAGE << std::endl;
+		return 0;
+	}
+	size_t count = (size - sizeof(LedgerHeader)) / sizeof(ContractRecord);
+	if (!ReadRecords(count)) {
+		return 0;
+	}
+
+	std::ofstream outputFile(Path, std::ios_base::binary | std::ios_base::app);
+	if (!outputFile.is_open()) {
+		std::cerr << ERRORMESSAGE << std::endl;
+		return 0;
+	}
+	outputFile.write(reinterpret_cast<const char*>(&record), sizeof(record));
+	if (!outputFile) {
+		return 0;
+	}
+	Records.push_back(record);
+	return static_cast<ContractId>(count + 1);
+}
+
+bool ContractLedger::ReadRecords(size_t count) {
+	if (count < Records.size()) {
+		std::cerr << ERRORMESSAGE << std::endl; // The ledger is only ever appended to, it cannot have lost records
+		return false;
+	}
+	if (count == Records.size()) {
+		return true;
+	}
+	std::ifstream inputFile(Path, std::ios_base::binary);
+	if (!inputFile.is_open()) {
+		std::cerr << ERRORMESSAGE << std::endl;
+		return false;
+	}
+	size_t known = Records.size();
+	inputFile.seekg(sizeof(LedgerHeader) + known * sizeof(ContractRecord));
+	Records.resize(count);
+	inputFile.read(reinterpret_cast<char*>(Records.data() + known), (count - known) * sizeof(ContractRecord));
+	if (!inputFile) {
+		Records.resize(known);
+		return false;
+	}
+	return true;
+}
+
+bool ContractLedger::SetState(ContractId id, ContractState state) {
+	if (!Valid || Find(id) == nullptr) {
+		return false;
+	}
+	std::lock_guard lock(FileWriter::GetFileLock(Path));
+	std::fstream file(Path, std::ios_base::binary | std::ios_base::in | std::ios_base::out);
+	if (!file.is_open()) {
+		std::cerr << ERRORMESSAGE << std::endl;
+		return false;
+	}
+	std::uint8_t value = static_cast<std::uint8_t>(state);
+	file.seekp(sizeof(LedgerHeader) + (id - 1) * sizeof(ContractRecord) + offsetof(ContractRecord, State));
+	file.write(reinterpret_cast<const char*>(&value), sizeof(value));
+	if (!file) {
+		return false;
+	}
+	Records[id - 1].State = value;
+	return true;
+}
+
+const ContractRecord* ContractLedger::Find(ContractId id) const {
+	if (id == 0 || id > Records.size()) {
+		return nullptr;
+	}
+	return &Records[id - 1];
+}
+
+size_t ContractLedger::GetSize() const {
+	return Records.size();
+}
+
+std::optional<ContractRecord> ContractLedger::CreateRecord(std::string_view customer, std::string_view licencePlate, std::chrono::system_clock::time_point start,
+	std::chrono::system_clock::time_point due, int hours, int price, ContractState state) {
+	ContractRecord record = {};
+	if (!SetField(record.Customer, sizeof(record.Customer), customer) || !SetField(record.LicencePlate, sizeof(record.LicencePlate), licencePlate)) {
+		return std::nullopt;
+	}
+	record.Start = std::chrono::duration_cast<std::chrono::seconds>(start.time_since_epoch()).count();
+	record.Due = std::chrono::duration_cast<std::chrono::seconds>(due.time_since_epoch()).count();
+	record.Hours = hours;
+	record.Price = price;
+	record.State = static_cast<std::uint8_t>(state);
+	return record;
+}
+
+std::optional<ContractRecord> ContractLedger::ReadLegacyContract(const std::filesystem::path& file, ContractState state) {
+	std::string name = file.stem().string();
+	std::optional<std::chrono::system_clock::time_point> due = GetContractDueDate(name);
+	if (!due) {
+		return std::nullopt;
+	}
+
+	// Surname_Plate_ is in front of the five parts of the date
+	size_t end = name.size();
+	for (int i = 0; i < 5; ++i) {
+		end = name.rfind('_', end - 1); // GetContractDueDate has already checked that there are five parts
+	}
+	size_t plateStart = end == 0 ? std::string::npos : name.rfind('_', end - 1);
+	if (plateStart == std::string::npos) {
+		return std::nullopt;
+	}
+	std::string surname = name.substr(0, plateStart);
+	std::string licencePlate = name.substr(plateStart + 1, end - plateStart - 1);
+
+	int hours = 0;
+	int price = 0;
+	std::ifstream inputFile(file);
+	std::string line;
+	while (std::getline(inputFile, line)) {
+		std::string_view text = line;
+		if (text.starts_with("Hours of rent: ")) {
+			TryParseNumber(text.substr(15), hours);
+		}
+		else if (text.starts_with("Total price: ")) {
+			TryParseNumber(text.substr(13), price);
+		}
+	}
+	return CreateRecord(surname, licencePlate, *due - std::chrono::hours(hours), *due, hours, price, state);
+}
+
+std::string ContractLedger::FormatTime(std::chrono::system_clock::time_point timePoint, const char* format) {
+	std::time_t time = std::chrono::system_clock::to_time_t(timePoint);
+	std::tm timeStruct;
+#ifdef _WIN32
+	localtime_s(&timeStruct, &time); // Use localtime_s for local time on Windows
+#else
+	localtime_r(&time, &timeStruct); // Use localtime_r for local time on POSIX systems
+#endif
+	std::ostringstream oss;
+	oss << std::put_time(&timeStruct, format);
+	return oss.str();
+}
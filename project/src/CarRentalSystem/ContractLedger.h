@@ -0,0 +1,142 @@
+#pragma once
+
+#ifndef _CONTRACTLEDGER_H_
+#define _CONTRACTLEDGER_H_
+
+#include <cstdint>
+#include <cstddef>
+#include "FileHandler.h"
+
+const std::filesystem::path CONTRACTSLEDGER = "Customers/Contracts/contracts.ledger";
+
+constexpr char LEDGERMAGIC[8] = { 'C', 'R', 'S', 'L', 'E', 'D', 'G', '\0' };
+constexpr std::uint32_t LEDGERVERSION = 1;
+constexpr std::uint32_t LEDGERBYTEORDER = 0x01020304; // The ledger is written in the native byte order and rejected on a machine with another one
+
+/**
+ * @brief The longest customer key (the phone number of the customer) a contract can store.
+ */
+constexpr size_t MAXCONTRACTCUSTOMERLENGTH = 63;
+
+/**
+ * @brief Identifies a contract by its position in the ledger, the first contract is 1. The identifier 0 means no contract.
+ */
+using ContractId = std::uint32_t;
+
+/**
+ * @brief The state of a contract. Archiving a contract only changes its state in the ledger.
+ */
+enum class ContractState : std::uint8_t { Active, Archived };
+
+/**
+ * @brief The header at the beginning of the ledger, followed by the fixed-width contract records.
+ */
+struct LedgerHeader {
+    char Magic[8];
+    std::uint32_t Version;
+    std::uint32_t ByteOrder;
+    std::uint32_t RecordSize;
+    std::uint32_t Reserved;
+};
+
+/**
+ * @brief A contract as it is stored in the ledger. The times are in seconds since the epoch.
+ */
+struct ContractRecord {
+    std::int64_t Start;
+    std::int64_t Due;
+    std::int32_t Hours;
+    std::int32_t Price;
+    char Customer[MAXCONTRACTCUSTOMERLENGTH + 1]; // Null-terminated
+    char LicencePlate[MAXLICENCEPLATELENGTH + 1]; // Null-terminated
+    std::uint8_t State;
+    std::uint8_t Reserved[7];
+
+    std::string_view GetCustomer() const;
+    std::string_view GetLicencePlate() const;
+    std::chrono::system_clock::time_point GetStart() const;
+    std::chrono::system_clock::time_point GetDue() const;
+    ContractState GetState() const;
+};
+
+static_assert(sizeof(ContractRecord) == 112, "The contract record is part of the ledger format");
+
+/**
+ * @brief The file of all the contracts, active and archived. New contracts are appended with one write
+ * and archiving a contract rewrites the one byte of its state, so the ledger never has to be rewritten.
+ * All the records are kept in memory.
+ */
+class ContractLedger {
+public:
+    /**
+     * @brief Reads all the contracts of the ledger, an empty ledger is created if there is none or the file is empty.
+     * A torn record at the end of the ledger (from an interrupted append) is cut off.
+     * @param ledger The path of the ledger.
+     * @return False if the ledger could not be read or created.
+     */
+    bool Open(const std::filesystem::path& ledger);
+
+    /**
+     * @brief Appends a contract to the ledger. The identifier is the position of the record in the file, so the contracts
+     * another writer has appended since the ledger was read are read first.
+     * @param record The contract.
+     * @return The identifier of the contract, 0 if it could not be written or the ledger was not opened.
+     */
+    ContractId Append(const ContractRecord& record);
+
+    /**
+     * @brief Changes the state of a contract in the ledger.
+     * @param id The identifier of the contract.
+     * @param state The new state.
+     * @return False if there is no such contract, the ledger could not be written or it was not opened.
+     */
+    bool SetState(ContractId id, ContractState state);
+
+    /**
+     * @brief Finds a contract.
+     * @param id The identifier of the contract.
+     * @return The contract, nullptr if there is no such contract.
+     */
+    const ContractRecord* Find(ContractId id) const;
+
+    /**
+     * @brief Retrieves the number of contracts in the ledger, which is also the identifier of the last one.
+     */
+    size_t GetSize() const;
+
+    /**
+     * @brief Creates a contract record.
+     * @return The record, std::nullopt if the customer key or the licence plate is too long.
+     */
+    static std::optional<ContractRecord> CreateRecord(std::string_view customer, std::string_view licencePlate, std::chrono::system_clock::time_point start,
+        std::chrono::system_clock::time_point due, int hours, int price, ContractState state = ContractState::Active);
+
+    /**
+     * @brief Reads a contract written as a text file before the ledger existed (Surname_Plate_YYYY_MM_DD_HH_MM.txt).
+     * The surname is used as the customer key.
+     * @param file The path of the contract file.
+     * @param state The state of the contract.
+     * @return The record, std::nullopt if the name of the file is not a contract name.
+     */
+    static std::optional<ContractRecord> ReadLegacyContract(const std::filesystem::path& file, ContractState state);
+
+    /**
+     * @brief Formats a time point in local time.
+     * @param timePoint The time point.
+     * @param format The format of std::put_time.
+     */
+    static std::string FormatTime(std::chrono::system_clock::time_point timePoint, const char* format);
+
+private:
+    /**
+     * @brief Reads the records behind the ones in memory, up to the given number of records.
+     * @return False if the records could not be read.
+     */
+    bool ReadRecords(size_t count);
+
+    std::filesystem::path Path;
+    bool Valid = false; // Nothing is written to a ledger whose header was not accepted
+    std::vector<ContractRecord> Records; // Records[id - 1] is the contract with the identifier id
+};
+
+#endif // !_CONTRACTLEDGER_H_
@@ -0,0 +1,63 @@
+#include "ContractTracker.h"
+#include <algorithm>
+
+void ContractTracker::Add(ContractId id, std::chrono::system_clock::time_point dueDate) {
+	Remove(id);
+	DueDates.emplace(id, dueDate);
+	Ids.insert(std::lower_bound(Ids.begin(), Ids.end(), id), id);
+	Pending.emplace(dueDate, id); // Becomes overdue with the next Refresh if the due date has already passed
+}
+
+bool ContractTracker::Remove(ContractId id) {
+	auto it = DueDates.find(id);
+	if (it == DueDates.end()) {
+		return false;
+	}
+	DueContract contract(it->second, id);
+	if (Pending.erase(contract) == 0) {
+		Overdue.erase(contract);
+	}
+	DueDates.erase(it);
+	Ids.erase(std::lower_bound(Ids.begin(), Ids.end(), id));
+	return true;
+}
+
+void ContractTracker::Clear() {
+	Pending.clear();
+	Overdue.clear();
+	DueDates.clear();
+	Ids.clear();
+}
+
+void ContractTracker::Refresh(std::chrono::system_clock::time_point now) {
+	while (!Pending.empty() && Pending.begin()->first < now) {
+		Overdue.insert(Overdue.end(), Pending.extract(Pending.begin()));
+	}
+}
+
+size_t ContractTracker::GetOverdueCount() const {
+	return Overdue.size();
+}
+
+std::vector<DueContract> ContractTracker::GetNextDue(size_t count) const {
+	std::vector<DueContract> result;
+	for (auto it = Pending.begin(); it != Pending.end() && result.size() < count; ++it) {
+		result.push_back(*it);
+	}
+	return result;
+}
+
+std::vector<DueContract> ContractTracker::GetOverdue() const {
+	return std::vector<DueContract>(Overdue.begin(), Overdue.end());
+}
+
+size_t ContractTracker::GetCount() const {
+	return Ids.size();
+}
+
+std::vector<ContractId> ContractTracker::GetIds(size_t first, size_t count) const {
+	if (first >= Ids.size()) {
+		return {};
+	}
+	return std::vector<ContractId>(Ids.begin() + first, Ids.begin() + std::min(first + count, Ids.size()));
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#ifndef _CONTRACTTRACKER_H_
+#define _CONTRACTTRACKER_H_
+
+#include <set>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "ContractLedger.h"
+
+/**
+ * @brief A contract and its due date.
+ */
+using DueContract = std::pair<std::chrono::system_clock::time_point, ContractId>;
+
+/**
+ * @brief Keeps the active contracts ordered by their due dates and knows which of them are overdue.
+ * The contracts that are not overdue yet are kept in due date order, Refresh moves the ones whose due date has passed
+ * to the overdue contracts, so every contract is moved at most once and the number of overdue contracts is read in constant time.
+ */
+class ContractTracker {
+public:
+    /**
+     * @brief Starts tracking a contract. A contract that is already tracked gets the new due date.
+     * @param id The identifier of the contract.
+     * @param dueDate The due date of the contract.
+     */
+    void Add(ContractId id, std::chrono::system_clock::time_point dueDate);
+
+    /**
+     * @brief Stops tracking a contract (for example because it was archived).
+     * @param id The identifier of the contract.
+     * @return True if the contract was tracked.
+     */
+    bool Remove(ContractId id);
+
+    /**
+     * @brief Removes all the contracts.
+     */
+    void Clear();
+
+    /**
+     * @brief Marks the contracts whose due date is before the given time as overdue.
+     * @param now The current time.
+     */
+    void Refresh(std::chrono::system_clock::time_point now);
+
+    /**
+     * @brief Retrieves the number of overdue contracts as of the last Refresh.
+     * @return The number of overdue contracts.
+     */
+    size_t GetOverdueCount() const;
+
+    /**
+     * @brief Retrieves the contracts that are due next (as of the last Refresh), the soonest first.
+     * @param count The maximum number of returned contracts.
+     * @return The contracts with their due dates.
+     */
+    std::vector<DueContract> GetNextDue(size_t count) const;
+
+    /**
+     * @brief Retrieves the overdue contracts (as of the last Refresh), the most overdue first.
+     * @return The contracts with their due dates.
+     */
+    std::vector<DueContract> GetOverdue() const;
+
+    /**
+     * @brief Retrieves the number of tracked contracts.
+     */
+    size_t GetCount() const;
+
+    /**
+     * @brief Retrieves a range of the tracked contracts in the order of their identifiers.
+     * @param first The position of the first returned contract.
+     * @param count The maximum number of returned contracts.
+     * @return The identifiers of the contracts.
+     */
+    std::vector<ContractId> GetIds(size_t first, size_t count) const;
+
+private:
+    std::set<DueContract> Pending; // Ordered by the due date, so the first contract is the next to become overdue
+    std::set<DueContract> Overdue;
+    std::unordered_map<ContractId, std::chrono::system_clock::time_point> DueDates; // Identifier -> due date of every tracked contract
+    std::vector<ContractId> Ids; // The identifiers of the tracked contracts in ascending order, a new contract usually goes to the end
+};
+
+#endif // !_CONTRACTTRACKER_H_
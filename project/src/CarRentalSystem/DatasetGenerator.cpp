@@ -0,0 +1,186 @@
+// Writes a synthetic data set into the src directory of the current directory (where CarRentalSystem and carrental_bench read it).
+// Usage: carrental_datagen [number of rows], the number of cars, customers and contracts (1000 to 10000000)
+// About a fifth of the cars are rented with active contracts, the other contracts are the archived history of the last two years.
+
+#include "Repository.h"
+#include <random>
+#include <cstring>
+
+constexpr size_t DEFAULTNUMBEROFROWS = 100000;
+constexpr size_t MINNUMBEROFROWS = 1000;
+constexpr size_t MAXNUMBEROFROWS = 10000000;
+constexpr size_t RENTEDCARSPERCENT = 20; // The rented cars, each of them has an active contract
+constexpr size_t OVERDUECONTRACTSPERCENT = 5; // The active contracts that are past their due date
+constexpr size_t SERVICEDCARSPERCENT = 5;
+constexpr size_t UNAVAILABLECARSPERCENT = 2;
+constexpr int HISTORYDAYS = 730; // The archived contracts ended within this many days
+constexpr size_t GENERATORBUFFERSIZE = 1 << 20;
+
+/**
+ * @brief A file written through a large buffer, the generated files are too big to be written line by line.
+ */
+class BufferedFile {
+public:
+	explicit BufferedFile(const std::filesystem::path& path) : File(path, std::ios_base::binary | std::ios_base::trunc) {
+		Buffer.reserve(GENERATORBUFFERSIZE);
+	}
+
+	~BufferedFile() {
+		Flush();
+	}
+
+	bool IsOpen() const {
+		return File.is_open();
+	}
+
+	void Write(std::string_view text) {
+		Buffer += text;
+		if (Buffer.size() >= GENERATORBUFFERSIZE) {
+			Flush();
+		}
+	}
+
+	void Flush() {
+		File.write(Buffer.data(), Buffer.size());
+		Buffer.clear();
+	}
+
+private:
+	std::ofstream File;
+	std::string Buffer;
+};
+
+/**
+ * @brief The licence plate of the generated car with the given number, unique and at most MAXLICENCEPLATELENGTH long.
+ */
+static std::string GetPlate(size_t number) {
+	return "G" + std::to_string(number);
+}
+
+/**
+ * @brief The phone number of the generated customer with the given number, unique and 10 digits long.
+ */
+static std::string GetPhone(size_t number) {
+	std::string digits = std::to_string(number);
+	return "6" + std::string(9 - digits.size(), '0') + digits;
+}
+
+int main(int argc, char* argv[]) {
+	size_t rows = DEFAULTNUMBEROFROWS;
+	if (argc > 1) {
+		int parsedRows = 0;
+		if (!TryParseNumber(argv[1], parsedRows) || parsedRows < static_cast<int>(MINNUMBEROFROWS) || static_cast<size_t>(parsedRows) > MAXNUMBEROFROWS) {
+			std::cerr << "The number of rows has to be between " << MINNUMBEROFROWS << " and " << MAXNUMBEROFROWS << std::endl;
+			return 1;
+		}
+		rows = static_cast<size_t>(parsedRows);
+	}
+
+	const std::vector<std::string> makes = { "Toyota", "Honda", "Ford", "Chevrolet", "Nissan", "Volkswagen", "Hyundai", "BMW", "Audi", "Skoda" };
+	const std::vector<std::string> models = { "Corolla", "Civic", "Focus", "Malibu", "Altima", "Jetta", "Elantra", "3 Series", "A4", "Octavia" };
+	const std::vector<std::string> colors = { "Blue", "Red", "Black", "White", "Silver", "Grey" };
+	const std::vector<std::string> motorizations = { "Gasoline", "Diesel", "Hybrid", "Electric" };
+	const std::vector<std::string> gearboxes = { "Manual", "Automatic" };
+	const std::vector<std::string> names = { "John", "Jane", "Petr", "Eva", "Tomas", "Anna", "Martin", "Lucie", "David", "Tereza" };
+	const std::vector<std::string> surnames = { "Doe", "Smith", "Novak", "Svoboda", "Dvorak", "Cerny", "Prochazka", "Kucera", "Vesely", "Horak" };
+	const std::vector<std::string> streets = { "Elm Street", "Oak Avenue", "Main Street", "Park Lane", "Hill Road" };
+
+	std::mt19937 generator(42);
+	auto pick = [&generator](const std::vector<std::string>& values) -> const std::string& {
+		return values[std::uniform_int_distribution<size_t>(0, values.size() - 1)(generator)];
+	};
+	auto number = [&generator](int from, int to) {
+		return std::uniform_int_distribution<int>(from, to)(generator);
+	};
+
+	// The data set is never written over existing data
+	std::error_code error;
+	if (std::filesystem::exists(SOURCEFILES, error)) {
+		std::cerr << SOURCEFILES.string() << " already exists, run the generator in an empty directory" << std::endl;
+		return 1;
+	}
+	for (const auto& directory : { "Cars", "Customers/Contracts", "Users" }) {
+		std::filesystem::create_directories(ConcatPaths(SOURCEFILES, directory), error);
+	}
+
+	// The cars, the first ones are rented so that the active contracts can refer to them
+	size_t rented = rows * RENTEDCARSPERCENT / 100;
+	size_t serviced = rows * SERVICEDCARSPERCENT / 100;
+	size_t unavailable = rows * UNAVAILABLECARSPERCENT / 100;
+	std::vector<int> costs(rows);
+	{
+		std::vector<std::unique_ptr<BufferedFile>> carFiles;
+		for (size_t i = 0; i < NUMBEROFCARSTATUSES; ++i) {
+			carFiles.push_back(std::make_unique<BufferedFile>(ConcatPaths(SOURCEFILES, GetCarsPath(static_cast<CarStatus>(i)))));
+			if (!carFiles.back()->IsOpen()) {
+				std::cerr << ERRORMESSAGE << std::endl;
+				return 1;
+			}
+			carFiles.back()->Write("MAKE#MODEL#YEAR#COLOR#LICENCE_PLATE#MOTORIZATION#GEARBOX#SEATS#COST_PER_HOUR\n");
+		}
+		for (size_t i = 0; i < rows; ++i) {
+			CarStatus status = i < rented ? CarStatus::Rented : i < rented + serviced ? CarStatus::Serviced
+				: i < rented + serviced + unavailable ? CarStatus::PermanentlyUnavailable : CarStatus::Available;
+			costs[i] = number(8, 60);
+			std::string line = pick(makes) + DELIMITER + pick(models) + DELIMITER + std::to_string(number(2005, 2024)) + DELIMITER + pick(colors) + DELIMITER
+				+ GetPlate(i) + DELIMITER + pick(motorizations) + DELIMITER + pick(gearboxes) + DELIMITER + std::to_string(number(2, 9)) + DELIMITER
+				+ std::to_string(costs[i]) + '\n';
+			carFiles[status]->Write(line);
+		}
+	}
+
+	{
+		BufferedFile customers(ConcatPaths(SOURCEFILES, CUSTOMERS));
+		customers.Write("NAME#SURNAME#EMAIL#PHONE#ADDRESS\n");
+		for (size_t i = 0; i < rows; ++i) {
+			const std::string& name = pick(names);
+			const std::string& surname = pick(surnames);
+			std::string email = name + '.' + surname + std::to_string(i) + "@example.com";
+			std::transform(email.begin(), email.end(), email.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+			customers.Write(name + DELIMITER + surname + DELIMITER + email + DELIMITER + GetPhone(i) + DELIMITER + std::to_string(number(1, 999)) + ' ' + pick(streets) + '\n');
+		}
+
+		BufferedFile users(ConcatPaths(SOURCEFILES, USERS));
+		users.Write("USERNAME#PASSWORD#ADMIN\nadmin#1234#1\nclerk#1234#0\n");
+	}
+
+	// The contracts are written straight into the ledger, the active ones first, then the history of the other cars
+	{
+		BufferedFile ledger(ConcatPaths(SOURCEFILES, CONTRACTSLEDGER));
+		LedgerHeader header = {};
+		std::memcpy(header.Magic, LEDGERMAGIC, sizeof(LEDGERMAGIC));
+		header.Version = LEDGERVERSION;
+		header.ByteOrder = LEDGERBYTEORDER;
+		header.RecordSize = sizeof(ContractRecord);
+		ledger.Write(std::string_view(reinterpret_cast<const char*>(&header), sizeof(header)));
+
+		std::chrono::system_clock::time_point now = std::chrono::floor<std::chrono::minutes>(std::chrono::system_clock::now());
+		for (size_t i = 0; i < rows; ++i) {
+			bool active = i < rented;
+			size_t car = active ? i : static_cast<size_t>(number(0, static_cast<int>(rows - 1)));
+			int hours = number(1, 24 * 14);
+			std::chrono::system_clock::time_point due;
+			if (!active) {
+				due = now - std::chrono::hours(number(1, 24 * HISTORYDAYS));
+			}
+			else if (i < rented * OVERDUECONTRACTSPERCENT / 100) {
+				due = now - std::chrono::hours(number(1, 24 * 7));
+			}
+			else {
+				due = now + std::chrono::hours(number(1, 24 * 30));
+			}
+			std::optional<ContractRecord> contract = ContractLedger::CreateRecord(GetPhone(static_cast<size_t>(number(0, static_cast<int>(rows - 1)))), GetPlate(car),
+				due - std::chrono::hours(hours), due, hours, hours * costs[car], active ? ContractState::Active : ContractState::Archived);
+			ledger.Write(std::string_view(reinterpret_cast<const char*>(&*contract), sizeof(*contract)));
+		}
+	}
+
+	// Loading the data set once builds the archive of the contract texts and the snapshots, so the first run of the benchmark does not pay for them
+	auto start = std::chrono::steady_clock::now();
+	Repository::Load();
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	std::cout << "Generated " << rows << " cars, customers and contracts in " << SOURCEFILES.string() << std::endl;
+	std::cout << "First load: " << seconds << " s, " << Repository::GetDelayedContractsCount() << " overdue contracts" << std::endl;
+	return 0;
+}
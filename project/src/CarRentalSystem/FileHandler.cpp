@@ -1,4 +1,9 @@
 #include "FileHandler.h"
+#include "Schema.h"
+#include <cstring>
+#include <charconv>
+#include <array>
+#include <limits>
 
 // Function for concatanating paths
 std::filesystem::path ConcatPaths(const std::filesystem::path& a, const std::filesystem::path& b) {
@@ -6,45 +11,77 @@ std::filesystem::path ConcatPaths(const std::filesystem::path& a, const std::fil
 	return c.make_preferred();
 }
 
-StorageVector FileReader::GetInfo(const std::filesystem::path& what) {
-	std::ifstream inputFile;
-	std::filesystem::path name = ConcatPaths(SOURCEFILES, what);
-	inputFile.open(name);
+std::filesystem::path GetCarsPath(CarStatus status) {
+	switch (status) {
+	case Serviced:
+		return SERVICEDCARS;
+	case Rented:
+		return RENTEDCARS;
+	case PermanentlyUnavailable:
+		return PERMANENTLYUNAVAILABLECARS;
+	default:
+		return AVAILABLECARS;
+	}
+}
 
-	StorageVector result;
+std::filesystem::path GetJournalPath(const std::filesystem::path& filename) {
+	std::filesystem::path journal = filename;
+	journal += JOURNALEXTENSION;
+	return journal;
+}
 
-	if (!inputFile.is_open()) {
-		std::cerr << ERRORMESSAGE << std::endl;
-		return result;
+std::optional<std::chrono::system_clock::time_point> GetContractDueDate(const std::string& contractName) {
+	// The date is made of the last five parts of the name, the surname itself can contain the separator
+	constexpr size_t DATEPARTS = 5;
+	int parts[DATEPARTS];
+	size_t end = contractName.size();
+	for (size_t i = DATEPARTS; i-- > 0;) {
+		if (end == 0) {
+			return std::nullopt;
+		}
+		size_t start = contractName.rfind('_', end - 1);
+		if (start == std::string::npos) {
+			return std::nullopt;
+		}
+		auto [last, error] = std::from_chars(contractName.data() + start + 1, contractName.data() + end, parts[i]);
+		if (error != std::errc() || last != contractName.data() + end) {
+			return std::nullopt;
+		}
+		end = start;
 	}
 
-	std::string line;
-	while (std::getline(inputFile, line)) { //Go through the file by lines after skipping the first line
-		std::stringstream ss(line);
-		std::vector<std::string> tokens;
-		std::string token;
+	return MakeLocalTimePoint(parts[0], parts[1], parts[2], parts[3], parts[4]);
+}
 
-		while (std::getline(ss, token, DELIMITER)) { //Split each line by a specified delimiter and create a vector from the tokens
-			tokens.push_back(token);
-		}
-		result.push_back(tokens); //Add the new vector to the result vector of vectors
+std::optional<std::chrono::system_clock::time_point> MakeLocalTimePoint(int year, int month, int day, int hour, int minute) {
+	std::tm localTime = {};
+	localTime.tm_year = year - 1900;
+	localTime.tm_mon = month - 1;
+	localTime.tm_mday = day;
+	localTime.tm_hour = hour;
+	localTime.tm_min = minute;
+	localTime.tm_isdst = -1; // Let mktime decide about the daylight saving time
+	std::time_t time = std::mktime(&localTime);
+	if (time == -1) {
+		return std::nullopt;
 	}
+	return std::chrono::system_clock::from_time_t(time);
+}
+
+StorageVector FileReader::GetInfo(const std::filesystem::path& what) {
+	std::filesystem::path name = ConcatPaths(SOURCEFILES, what);
+
+	StorageVector result;
+
+	ForEachRecord(name, [&result](PropertyViews fields) {
+		result.emplace_back(fields.begin(), fields.end()); //Add the new vector to the result vector of vectors
+		});
 
-	inputFile.close();
 	return result;
 }
 
 StorageVector FileReader::GetCars(CarStatus status) {
-	switch (status) {
-	case Available:
-		return GetInfo(AVAILABLECARS);
-	case Serviced:
-		return GetInfo(SERVICEDCARS);
-	case Rented:
-		return GetInfo(RENTEDCARS);
-	case PermanentlyUnavailable:
-		return GetInfo(PERMANENTLYUNAVAILABLECARS);
-	}	
+	return GetInfo(GetCarsPath(status));
 }
 
 StorageVector FileReader::GetCustomers() {
@@ -63,41 +100,174 @@ StorageVector FileReader::GetArchivedContracs() {
 	return GetNamesOfFiles(ConcatPaths(SOURCEFILES, ARCHIVEDCONTRACTS));
 }
 
-Properties FileReader::FindRecordByToken(const std::filesystem::path& filename, const std::string& token) {
+bool LineContainsToken(const std::string& line, const std::string& token, size_t column) {
+	std::istringstream iss(line);
+	std::string currentToken;
+	for (size_t i = 0; std::getline(iss, currentToken, DELIMITER); ++i) {
+		if ((column == ANYCOLUMN || column == i) && currentToken == token) { // Check for exact match
+			return true;
+		}
+		if (i == column) {
+			break;
+		}
+	}
+	return false;
+}
+
+Properties FileReader::FindRecordByToken(const std::filesystem::path& filename, const std::string& token, size_t column) {
 	Properties Props;
 
+	std::vector<std::string> lines = GetLines(filename);
+	auto it = std::find_if(lines.begin(), lines.end(), [&](const std::string& line) {
+		return LineContainsToken(line, token, column);
+		});
+
+	if (it != lines.end()) {
+		std::istringstream iss(*it);
+		std::string token;
+		while (std::getline(iss, token, DELIMITER)) {
+			Props.push_back(token);
+		}
+	}
+
+	return Props;
+}
+
+std::vector<std::string> FileReader::GetLines(const std::filesystem::path& filename) {
+	std::vector<std::string> lines;
+
 	std::ifstream inputFile(filename);
 	if (!inputFile.is_open()) {
 		std::cerr << ERRORMESSAGE << std::endl;
-		return Props;
+		return lines;
 	}
 
+	// Nothing was deleted since the last compaction if there are no tombstones
+	Tombstones tombstones = ReadTombstones(filename);
+	std::vector<std::string_view> fields;
+	std::uintmax_t offset = 0;
 	std::string line;
-	bool found = false;
 	while (std::getline(inputFile, line)) {
-		std::istringstream iss(line);
-		std::string currentToken;
-		while (std::getline(iss, currentToken, DELIMITER)) {
-			if (currentToken == token) { // Check for exact match
-				found = true;
-				break;
+		if (!tombstones.empty()) {
+			SplitRecord(line, fields);
+			if (IsDeleted(tombstones, fields, offset)) {
+				offset += line.size() + 1;
+				continue;
 			}
 		}
-		if (found) {
-			break;
+		offset += line.size() + 1;
+		lines.push_back(line);
+	}
+	return lines;
+}
+
+bool FileReader::ForEachRecord(const std::filesystem::path& filename, const RecordCallback& callback) {
+	MappedFile file(filename);
+	if (!file.IsOpen()) {
+		std::cerr << ERRORMESSAGE << std::endl;
+		return false;
+	}
+
+	Tombstones tombstones = ReadTombstones(filename);
+
+	const std::string_view whole = file.GetContent();
+	std::string_view content = whole;
+	std::vector<std::string_view> fields; // Reused for every line, so the loop does not allocate
+	while (!content.empty()) {
+		const char* end = static_cast<const char*>(std::memchr(content.data(), '\n', content.size()));
+		size_t lineLength = end == nullptr ? content.size() : static_cast<size_t>(end - content.data());
+		std::uintmax_t offset = static_cast<std::uintmax_t>(content.data() - whole.data());
+
+		SplitRecord(content.substr(0, lineLength), fields);
+		content.remove_prefix(end == nullptr ? lineLength : lineLength + 1);
+
+		if (tombstones.empty() || !IsDeleted(tombstones, fields, offset)) {
+			callback(fields);
 		}
 	}
-	inputFile.close();
+	return true;
+}
 
-	if (found) {
-		std::istringstream iss(line);
-		std::string token;
-		while (std::getline(iss, token, DELIMITER)) {
-			Props.push_back(token);
+size_t FileReader::CountLines(const std::filesystem::path& filename) {
+	MappedFile file(filename);
+	std::string_view content = file.GetContent();
+	size_t lines = static_cast<size_t>(std::count(content.begin(), content.end(), '\n'));
+	if (!content.empty() && content.back() != '\n') {
+		++lines; // The last line is not terminated
+	}
+	return lines;
+}
+
+FileReader::Tombstones FileReader::ReadTombstones(const std::filesystem::path& filename) {
+	Tombstones tombstones;
+
+	std::ifstream journal(GetJournalPath(filename));
+	if (!journal.is_open()) {
+		return tombstones;
+	}
+
+	std::string line;
+	while (std::getline(journal, line)) {
+		if (line.empty()) {
+			continue;
+		}
+		// A tombstone without the size (column#token) was written before the sizes were, it may delete any record
+		size_t sizeStart = line.rfind(DELIMITER);
+		std::uintmax_t size = std::numeric_limits<std::uintmax_t>::max();
+		if (sizeStart != line.find(DELIMITER)) {
+			std::from_chars(line.data() + sizeStart + 1, line.data() + line.size(), size);
+			line.resize(sizeStart);
+		}
+		tombstones[line].insert(size);
+	}
+	return tombstones;
+}
+
+bool FileReader::IsDeleted(Tombstones& tombstones, PropertyViews fields, std::uintmax_t offset) {
+	std::string key;
+	auto useUp = [&tombstones, &key, offset]() {
+		auto it = tombstones.find(key);
+		if (it == tombstones.end()) {
+			return false;
+		}
+		// The earliest tombstone written after the record was added deletes it
+		auto size = it->second.upper_bound(offset);
+		if (size == it->second.end()) {
+			return false;
+		}
+		it->second.erase(size);
+		return true;
+	};
+
+	for (size_t i = 0; i < fields.size(); ++i) {
+		key.assign(std::to_string(i)).append(1, DELIMITER).append(fields[i]);
+		if (useUp()) {
+			return true;
+		}
+		key.assign(ANYCOLUMNMARK).append(1, DELIMITER).append(fields[i]);
+		if (useUp()) {
+			return true;
 		}
 	}
+	return false;
+}
 
-	return Props;
+void FileReader::SplitRecord(std::string_view line, std::vector<std::string_view>& fields) {
+	fields.clear();
+	if (!line.empty() && line.back() == '\r') {
+		line.remove_suffix(1);
+	}
+	// Behaves like splitting by std::getline: an empty line has no properties and a trailing delimiter does not start a new one
+	while (!line.empty()) {
+		const char* delimiter = static_cast<const char*>(std::memchr(line.data(), DELIMITER, line.size()));
+		if (delimiter == nullptr) {
+			fields.push_back(line);
+			break;
+		}
+		size_t length = static_cast<size_t>(delimiter - line.data());
+		fields.push_back(line.substr(0, length));
+		line.remove_prefix(length + 1);
+	}
 }
 
 StorageVector FileReader::GetNamesOfFiles(const std::filesystem::path& directoryPath) {
@@ -122,101 +292,92 @@ StorageVector FileReader::GetNamesOfFiles(const std::filesystem::path& directory
 
 
 
-void FileWriter::CreateNewContract(const Customer& customer, const Car& car, const std::chrono::system_clock::time_point& dueDate) {
-	std::ofstream outputFile;
-
-	std::filesystem::path name = ConcatPaths(SOURCEFILES, ConcatPaths( ACTIVECONTRACTS, (customer.GetSurname() + "_" + car.GetLicencePlate() + "_" + TimePointToString(dueDate, "_") + ".txt")));
-
-
-	outputFile.open(name);
-
-	if (!outputFile.is_open()) {
-		std::cerr << ERRORMESSAGE << std::endl;
-		return;
-	}
-
+bool FileWriter::Journaling = true;
 
-	std::time_t dueDateTime = std::chrono::system_clock::to_time_t(dueDate);
-	std::tm dueDateStruct;
-#ifdef _WIN32
-	localtime_s(&dueDateStruct, &dueDateTime); // Use gmtime_s on Windows
-#else
-	localtime_r(&dueDateTime, &dueDateStruct); // Use gmtime_r on POSIX systems
-#endif
-
-	std::chrono::system_clock::time_point now = std::chrono::system_clock::now();
-	std::time_t nowTime = std::chrono::system_clock::to_time_t(now);
-	std::tm nowDate;
-#ifdef _WIN32
-	localtime_s(&nowDate, &nowTime); // Use localtime_s on Windows
-#else
-	localtime_r(&nowTime, &nowDate); // Use localtime_r on POSIX systems
-#endif
-
-	auto duration = dueDate - now;
-
-	auto hours = std::chrono::duration_cast<std::chrono::hours>(duration).count();
-
-	// Contract format
-
-	outputFile << "Contract Details:" << std::endl;
-	outputFile << "Customer: " << customer.GetName() << " " << customer.GetSurname() << std::endl;
-	outputFile << "Car: " << car.GetMake() << " " << car.GetModel() << ", License Plate: " << car.GetLicencePlate() << std::endl;
-	outputFile << "Due Date: " << std::put_time(&dueDateStruct, "%d. %m. %Y") << std::endl;
-	outputFile << "Due Hours: " << std::put_time(&dueDateStruct, "%H:%M") << std::endl;
-	outputFile << "Hours of rent: " << hours << std::endl;
-	outputFile << "Total price: " << hours * car.GetCostPerHour()<< "Kc" << std::endl;
-	outputFile << std::endl;
-	outputFile << "Signed on: " << std::put_time(&nowDate, "%d. %m. %Y") << std::endl;
-	outputFile << std::endl;
-	outputFile << "Customers signutare:......." << std::endl;
-	outputFile << "Representative signutare:......." << std::endl;
+void FileWriter::SetJournaling(bool enabled) {
+	Journaling = enabled;
+}
 
-	outputFile.close();
+std::recursive_mutex& FileWriter::GetFileLock(const std::filesystem::path& filename) {
+	static std::array<std::recursive_mutex, FILELOCKSTRIPES> locks;
+	return locks[std::hash<std::string>{}(filename.lexically_normal().string()) % FILELOCKSTRIPES];
 }
 
-void FileWriter::DeleteRecordInFile(const std::filesystem::path& filename, const std::string& token) {
-	std::ifstream inputFile(filename);
-	if (!inputFile.is_open()) {
-		std::cerr << ERRORMESSAGE << std::endl;
+void FileWriter::DeleteRecordInFile(const std::filesystem::path& filename, const std::string& token, size_t column) {
+	std::lock_guard lock(GetFileLock(filename));
+	if (Journaling) {
+		// The size of the file limits the tombstone to the records added before it, a tombstone without a matching record
+		// stays pending until the next compaction but never deletes a record with the token added later
+		std::error_code error;
+		std::uintmax_t size = std::filesystem::file_size(filename, error);
+		std::filesystem::path journalPath = GetJournalPath(filename);
+		std::ofstream journal(journalPath, std::ios_base::app);
+		if (error || !journal.is_open()) {
+			std::cerr << ERRORMESSAGE << std::endl;
+			return;
+		}
+		journal << (column == ANYCOLUMN ? std::string(ANYCOLUMNMARK) : std::to_string(column)) << DELIMITER << token << DELIMITER << size << std::endl;
+		journal.close();
+
+		if (std::filesystem::file_size(journalPath, error) >= JOURNALCOMPACTIONSIZE && !error) {
+			CompactFile(filename);
+		}
 		return;
 	}
 
-	std::vector<std::string> lines;
-	std::string line;
-	while (std::getline(inputFile, line)) {
-		lines.push_back(line);
-	}
-	inputFile.close();
+	std::vector<std::string> lines = FileReader::GetLines(filename);
 
 	auto it = std::find_if(lines.begin(), lines.end(), [&](const std::string& str) {
-		std::istringstream iss(str);
-		std::string currentToken;
-		while (std::getline(iss, currentToken, DELIMITER)) {
-			if (currentToken == token) { // Check for exact match
-				return true;
-			}
-		}
-		return false;
+		return LineContainsToken(str, token, column);
 		});
 
 	if (it != lines.end()) {
 		lines.erase(it);
 
-		std::ofstream outputFile(filename);
-		if (!outputFile.is_open()) {
-			std::cerr << ERRORMESSAGE << std::endl;
-			return;
-		}
-		for (const auto& line : lines) {
-			outputFile << line << std::endl;
+		if (WriteLines(lines, filename)) {
+			std::filesystem::remove(GetJournalPath(filename)); // The lines were read with the journal applied
 		}
-		outputFile.close();
 	}
 
 	return;
 }
 
+void FileWriter::CompactFile(const std::filesystem::path& filename) {
+	std::lock_guard lock(GetFileLock(filename));
+	std::filesystem::path journalPath = GetJournalPath(filename);
+	if (!std::filesystem::exists(journalPath)) {
+		return;
+	}
+
+	std::filesystem::path temporaryPath = filename;
+	temporaryPath += ".tmp";
+	if (!WriteLines(FileReader::GetLines(filename), temporaryPath)) {
+		return;
+	}
+
+	// The journal is removed before the file is replaced, so an interruption can only bring deleted records back and never deletes a record twice.
+	try {
+		std::filesystem::remove(journalPath);
+		std::filesystem::rename(temporaryPath, filename);
+	}
+	catch (const std::filesystem::filesystem_error& e) {
+		std::cerr << "Filesystem error: " << e.what() << std::endl;
+	}
+}
+
+bool FileWriter::WriteLines(const std::vector<std::string>& lines, const std::filesystem::path& filename) {
+	std::ofstream outputFile(filename);
+	if (!outputFile.is_open()) {
+		std::cerr << ERRORMESSAGE << std::endl;
+		return false;
+	}
+	for (const auto& line : lines) {
+		outputFile << line << '\n';
+	}
+	outputFile.close();
+	return true;
+}
+
 void FileWriter::MoveFileToFolder(const std::filesystem::path& sourceFolder, const std::filesystem::path& destinationFolder, const std::string& fileName) {
 	std::filesystem::path sourcePath = ConcatPaths(sourceFolder, fileName);
 	std::filesystem::path destinationPath = ConcatPaths(destinationFolder,fileName);
@@ -231,9 +392,10 @@ void FileWriter::MoveFileToFolder(const std::filesystem::path& sourceFolder, con
 	}
 }
 
-void FileWriter::AddInfo(const Properties& props, const std::filesystem::path& what) {
+void FileWriter::AddInfo(std::string_view record, const std::filesystem::path& what) {
 	std::ofstream outputFile;
 	std::filesystem::path name = ConcatPaths(SOURCEFILES, what);
+	std::lock_guard lock(GetFileLock(name));
 	outputFile.open(name, std::ios_base::app);
 
 	if (!outputFile.is_open()) {
@@ -241,54 +403,24 @@ void FileWriter::AddInfo(const Properties& props, const std::filesystem::path& w
 		return;
 	}
 
-	for (size_t i = 0; i < props.size(); ++i) {
-		outputFile << props[i];
-		if (i < props.size() - 1) {
-			outputFile << DELIMITER;
-		}
-	}
-	outputFile << std::endl;
-
+	outputFile.write(record.data(), static_cast<std::streamsize>(record.size()));
 	outputFile.close();
 }
 
 void FileWriter::AddCar(const Car& car, CarStatus status) {
-	switch (status) {
-	case Available:
-		AddInfo(car.GetProperties(), AVAILABLECARS);
-		break;
-	case Serviced:
-		AddInfo(car.GetProperties(), SERVICEDCARS);
-		break;
-	case Rented:
-		AddInfo(car.GetProperties(), RENTEDCARS);
-		break;
-	case PermanentlyUnavailable:
-		AddInfo(car.GetProperties(), PERMANENTLYUNAVAILABLECARS);
-		break;
-	}
+	std::string record;
+	SerializeRecord(car, record);
+	AddInfo(record, GetCarsPath(status));
 }
 
 void FileWriter::AddCustomer(const Customer& customer) {
-	AddInfo(customer.GetProperties(), CUSTOMERS);
+	std::string record;
+	SerializeRecord(customer, record);
+	AddInfo(record, CUSTOMERS);
 }
 
 void FileWriter::AddUser(const User& user) {
-	AddInfo(user.GetProperties(), USERS);
+	std::string record;
+	SerializeRecord(user, record);
+	AddInfo(record, USERS);
 }
-
-std::string FileWriter::TimePointToString(const std::chrono::system_clock::time_point& timePoint, const std::string& delimiter) {
-	std::time_t timeT = std::chrono::system_clock::to_time_t(timePoint);
-
-	std::tm timeStruct;
-#ifdef _WIN32
-	localtime_s(&timeStruct, &timeT); // Use localtime_s for local time on Windows
-#else
-	localtime_r(&timeT,&timeStruct); // Use localtime_r for local time on POSIX systems
-#endif
-
-	std::ostringstream oss;
-	oss << std::put_time(&timeStruct, ("%Y" + delimiter + "%m" + delimiter + "%d" + delimiter + "%H" + delimiter + "%M").c_str());
-
-	return oss.str();
-}
\ No newline at end of file
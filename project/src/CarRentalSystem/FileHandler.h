@@ -8,7 +8,14 @@
 #include <ctime>
 #include <chrono>
 #include <filesystem>
+#include <algorithm>
+#include <unordered_map>
+#include <set>
+#include <functional>
+#include <optional>
+#include <mutex>
 #include "Objects.h"
+#include "MappedFile.h"
 
 const std::filesystem::path SOURCEFILES = std::filesystem::current_path() += "/src/";
 const std::filesystem::path SERVICEDCARS = "Cars/repair_shop.txt";
@@ -20,15 +27,29 @@ const std::filesystem::path CUSTOMERS = "Customers/customers.txt";
 const std::filesystem::path ACTIVECONTRACTS = "Customers/Contracts/Active/";
 const std::filesystem::path ARCHIVEDCONTRACTS = "Customers/Contracts/Archived/";
 constexpr char ERRORMESSAGE[] = "Error opening file.";
+constexpr char JOURNALEXTENSION[] = ".journal";
+constexpr char ANYCOLUMNMARK[] = "*";
+constexpr std::uintmax_t JOURNALCOMPACTIONSIZE = 64 * 1024; // Size of a journal (in bytes) at which it is folded back into its file
+constexpr size_t FILELOCKSTRIPES = 16;
 
 constexpr char DELIMITER = '#';
 
+/**
+* @brief Used instead of a column position when a token can be in any column of a record.
+*/
+constexpr size_t ANYCOLUMN = static_cast<size_t>(-1);
+
 
 /**
 * @brief A storage container that represents the properties of either all the cars, all the customers or all the users.
 */
 using StorageVector = std::vector<Properties>;
 
+/**
+* @brief A function called for every record of a file. The views are valid only during the call.
+*/
+using RecordCallback = std::function<void(PropertyViews)>;
+
 /*
 * @brief A simple function that easily concatenates two paths
 */
@@ -36,6 +57,32 @@ std::filesystem::path ConcatPaths(const std::filesystem::path& a, const std::fil
 
 enum CarStatus { Available, Serviced, Rented, PermanentlyUnavailable };
 
+/**
+ * @brief Number of the different car statuses (and therefore of the car files).
+ */
+constexpr size_t NUMBEROFCARSTATUSES = 4;
+
+/*
+* @brief Returns the path (relative to SOURCEFILES) of the file that stores the cars with the given status
+*/
+std::filesystem::path GetCarsPath(CarStatus status);
+
+/*
+* @brief Returns the path of the journal of the given file. The journal holds the records deleted from the file that were not yet compacted.
+*/
+std::filesystem::path GetJournalPath(const std::filesystem::path& filename);
+
+/*
+* @brief Reads the due date from the name of a contract (Surname_Plate_YYYY_MM_DD_HH_MM, the date is in local time).
+* Returns std::nullopt if the name does not end with a valid date.
+*/
+std::optional<std::chrono::system_clock::time_point> GetContractDueDate(const std::string& contractName);
+
+/*
+* @brief Creates a time point from a date and time in local time. Returns std::nullopt if the time cannot be represented.
+*/
+std::optional<std::chrono::system_clock::time_point> MakeLocalTimePoint(int year, int month, int day, int hour, int minute);
+
 class FileReader {
 public:
     /**
@@ -58,13 +105,13 @@ public:
     static StorageVector GetUsers();
 
     /**
-     * @brief Get the names of files with active contracts.
+     * @brief Get the names of files with active contracts written before the contracts ledger existed.
      * @return A StorageVector containing the names of files with active contracts.
      */
     static StorageVector GetActiveContracs();
 
     /**
-     * @brief Get the names of files with archived contracts.
+     * @brief Get the names of files with archived contracts written before the contracts ledger existed.
      * @return A StorageVector containing the names of files with archived contracts.
      */
     static StorageVector GetArchivedContracs();
@@ -73,9 +120,34 @@ public:
      * @brief This function finds a certain record that has a property that equals the given token. Then returns the whole line.
      * @param filename The name of the file to search.
      * @param token The token to search for.
+     * @param column The position of the property that has to equal the token, ANYCOLUMN to search all the properties.
      * @return Properties containing the matching record.
      */
-    static Properties FindRecordByToken(const std::filesystem::path& filename, const std::string& token);
+    static Properties FindRecordByToken(const std::filesystem::path& filename, const std::string& token, size_t column = ANYCOLUMN);
+
+    /**
+     * @brief Returns all the lines of the given file. The records deleted in the journal of the file are left out.
+     * Every tombstone in the journal deletes the first record that contains its token.
+     * @param filename The name of the file to read.
+     * @return A vector containing the lines of the file.
+     */
+    static std::vector<std::string> GetLines(const std::filesystem::path& filename);
+
+    /**
+     * @brief Maps the given file into memory and calls the callback for every record that was not deleted in the journal of the file.
+     * The properties are views pointing directly into the mapped file, so nothing is copied.
+     * @param filename The name of the file to read.
+     * @param callback The function called for every record.
+     * @return False if the file could not be opened.
+     */
+    static bool ForEachRecord(const std::filesystem::path& filename, const RecordCallback& callback);
+
+    /**
+     * @brief Counts the lines of the given file without parsing them (for example to reserve memory before a bulk load).
+     * @param filename The name of the file.
+     * @return The number of lines, 0 if the file could not be opened.
+     */
+    static size_t CountLines(const std::filesystem::path& filename);
 
 private:
     /**
@@ -91,6 +163,35 @@ private:
      * @return A StorageVector containing the names of files in the directory.
      */
     static StorageVector GetNamesOfFiles(const std::filesystem::path& directoryPath);
+
+    /**
+     * @brief The tombstones of a journal by their "column#token", each with the sizes the file had when its tombstones were written
+     * ("column#token#size"). A tombstone deletes one record that starts before its size.
+     */
+    using Tombstones = std::unordered_map<std::string, std::multiset<std::uintmax_t>>;
+
+    /**
+     * @brief A private function that reads the tombstones from the journal of the given file.
+     * @param filename The name of the file whose journal is read.
+     * @return The tombstones, empty if there is no journal.
+     */
+    static Tombstones ReadTombstones(const std::filesystem::path& filename);
+
+    /**
+     * @brief A private function that decides if a record was deleted by one of the tombstones. The matching tombstone is used up.
+     * @param tombstones The tombstones of the file.
+     * @param fields The properties of the record.
+     * @param offset The position of the record in the file.
+     * @return True if the record was deleted.
+     */
+    static bool IsDeleted(Tombstones& tombstones, PropertyViews fields, std::uintmax_t offset);
+
+    /**
+     * @brief A private function that splits a line of a file by the DELIMITER.
+     * @param line The line to split, a trailing carriage return is ignored.
+     * @param fields The vector the views of the properties are stored to, its previous content is discarded.
+     */
+    static void SplitRecord(std::string_view line, std::vector<std::string_view>& fields);
 };
 
 class FileWriter {
@@ -115,18 +216,13 @@ public:
 
     /**
      * @brief Delete a record in the given file. This function searches the file for the line with the token inside. If it finds it, it deletes it, if not, it does nothing.
+     * In the journaled mode only a tombstone is appended to the journal of the file, the file itself is rewritten once the journal grows over JOURNALCOMPACTIONSIZE.
+     * The tombstone carries the size of the file, so it only deletes a record that is in the file by now and never one added later.
      * @param filename The name of the file to delete the record from.
      * @param token The token to search for in the file.
+     * @param column The position of the property that has to equal the token, ANYCOLUMN to search all the properties.
      */
-    static void DeleteRecordInFile(const std::filesystem::path& filename, const std::string& token);
-
-    /**
-     * @brief Create a new contract between a user and a customer.
-     * @param customer The customer involved in the contract.
-     * @param car The car involved in the contract.
-     * @param dueDateStruct The due date of the contract.
-     */
-    static void CreateNewContract(const Customer& customer, const Car& car, const std::chrono::system_clock::time_point& dueDateStruct);
+    static void DeleteRecordInFile(const std::filesystem::path& filename, const std::string& token, size_t column = ANYCOLUMN);
 
     /**
      * @brief Move a file between two folders.
@@ -136,22 +232,52 @@ public:
      */
     static void MoveFileToFolder(const std::filesystem::path& sourceFolder, const std::filesystem::path& destinationFolder, const std::string& fileName);
 
+    /**
+     * @brief Folds the journal of the given file back into the file and removes the journal.
+     * @param filename The name of the file to compact.
+     */
+    static void CompactFile(const std::filesystem::path& filename);
+
+    /**
+     * @brief Turns the journaled mode of deleting records on or off. The journaled mode is on by default.
+     * @param enabled True to append deletions to journals, false to rewrite the files right away.
+     */
+    static void SetJournaling(bool enabled);
+
+    /**
+     * @brief Retrieves the lock of the given file. The files share FILELOCKSTRIPES locks by the hash of their paths,
+     * so the writes of one file never interleave while the writes of different files mostly do not wait for each other.
+     * @param filename The full path of the file.
+     */
+    static std::recursive_mutex& GetFileLock(const std::filesystem::path& filename);
+
 private:
     /**
-     * @brief A private function that writes the given properties to the file of the given name.
-     * @param props The properties to write.
-     * @param what The name of the file to write the properties to.
+     * @brief A private function that appends the given serialized record to the file of the given name with one write.
+     * @param record The record including its line ending.
+     * @param what The name of the file to write the record to.
      */
-    static void AddInfo(const Properties& props, const std::filesystem::path& what);
+    static void AddInfo(std::string_view record, const std::filesystem::path& what);
 
     /**
-     * @brief A private function that returns the time point as a string with the given delimiter.
-     * @param timePoint The time point to convert to string.
-     * @param delimiter The delimiter to use in the string.
-     * @return A string representing the time point.
+     * @brief A private function that writes the given lines to the file of the given name, replacing its content.
+     * @param lines The lines to write.
+     * @param filename The name of the file to write the lines to.
+     * @return True if the file was written.
      */
-    static std::string TimePointToString(const std::chrono::system_clock::time_point& timePoint, const std::string& delimiter);
+    static bool WriteLines(const std::vector<std::string>& lines, const std::filesystem::path& filename);
+
+    static bool Journaling;
 };
 
+/**
+ * @brief Decides if a record (a line of a file) contains the given token.
+ * @param line The line to search.
+ * @param token The token to search for.
+ * @param column The position of the property that has to equal the token, ANYCOLUMN to search all the properties.
+ * @return True if the line contains the token.
+ */
+bool LineContainsToken(const std::string& line, const std::string& token, size_t column = ANYCOLUMN);
+
 #endif
 
@@ -0,0 +1,94 @@
+// Compares filtering the fleet as rows of strings (the way FileReader returns it) with the columnar FleetView.
+// Usage: carrental_fleet_bench [number of cars]
+
+#include "FleetView.h"
+#include <random>
+#include <iomanip>
+
+constexpr size_t DEFAULTNUMBEROFCARS = 1000000;
+constexpr int REPETITIONS = 10;
+
+/**
+ * @brief Generates the properties of synthetic cars.
+ */
+static StorageVector GenerateRows(size_t count) {
+	const std::vector<std::string> makes = { "Toyota", "Honda", "Ford", "Chevrolet", "Nissan", "Volkswagen", "Hyundai", "BMW", "Audi", "Skoda" };
+	const std::vector<std::string> models = { "Corolla", "Civic", "Focus", "Malibu", "Altima", "Jetta", "Elantra", "3 Series", "A4", "Octavia" };
+	const std::vector<std::string> colors = { "Blue", "Red", "Black", "White", "Silver", "Grey" };
+	const std::vector<std::string> motorizations = { "Gasoline", "Diesel", "Hybrid", "Electric" };
+	const std::vector<std::string> gearboxes = { "Manual", "Automatic" };
+
+	std::mt19937 generator(42);
+	auto pick = [&generator](const std::vector<std::string>& values) {
+		return values[std::uniform_int_distribution<size_t>(0, values.size() - 1)(generator)];
+	};
+
+	StorageVector rows;
+	rows.reserve(count);
+	for (size_t i = 0; i < count; ++i) {
+		rows.push_back({ pick(makes), pick(models), std::to_string(std::uniform_int_distribution<int>(2005, 2024)(generator)), pick(colors),
+			"P" + std::to_string(i), pick(motorizations), pick(gearboxes), std::to_string(std::uniform_int_distribution<int>(2, 9)(generator)),
+			std::to_string(std::uniform_int_distribution<int>(8, 60)(generator)) });
+	}
+	return rows;
+}
+
+/**
+ * @brief Runs the function REPETITIONS times and returns the best time in milliseconds.
+ */
+template <typename Function>
+static double Measure(Function function) {
+	double best = 0;
+	for (int i = 0; i < REPETITIONS; ++i) {
+		auto start = std::chrono::steady_clock::now();
+		function();
+		double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		if (i == 0 || elapsed < best) {
+			best = elapsed;
+		}
+	}
+	return best;
+}
+
+int main(int argc, char* argv[]) {
+	size_t count = argc > 1 ? std::stoul(argv[1]) : DEFAULTNUMBEROFCARS;
+
+	StorageVector rows = GenerateRows(count);
+	std::vector<Car> cars;
+	std::vector<CarStatus> statuses;
+	cars.reserve(count);
+	for (size_t i = 0; i < rows.size(); ++i) {
+		cars.emplace_back(rows[i]);
+		statuses.push_back(static_cast<CarStatus>(i % 4));
+	}
+	FleetView fleet;
+	fleet.Build(cars, statuses);
+
+	// Cars with at least 7 seats under 20 per hour built after 2019
+	size_t rowsMatches = 0;
+	double rowsTime = Measure([&]() {
+		rowsMatches = 0;
+		for (const auto& row : rows) {
+			if (std::stoi(row[7]) >= 7 && std::stoi(row[8]) < 20 && std::stoi(row[2]) > 2019) {
+				++rowsMatches;
+			}
+		}
+		});
+
+	FleetQuery query;
+	query.MinSeats = 7;
+	query.MaxCostPerHour = 19;
+	query.MinYear = 2020;
+	size_t columnarMatches = 0;
+	double columnarTime = Measure([&]() {
+		columnarMatches = FleetView::Count(fleet.Select(query));
+		});
+
+	std::cout << "Cars: " << count << std::endl;
+	std::cout << std::fixed << std::setprecision(3);
+	std::cout << "Rows of strings: " << rowsTime << " ms, " << rowsMatches << " matches" << std::endl;
+	std::cout << "Columnar view:   " << columnarTime << " ms, " << columnarMatches << " matches" << std::endl;
+	std::cout << "Speedup:         " << (columnarTime > 0 ? rowsTime / columnarTime : 0) << "x" << std::endl;
+
+	return rowsMatches == columnarMatches ? 0 : 1;
+}
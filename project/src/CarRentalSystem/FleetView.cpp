@@ -0,0 +1,241 @@
+#include "FleetView.h"
+#include <algorithm>
+#include <bit>
+#include <cctype>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define FLEETVIEW_SSE2
+#include <emmintrin.h>
+#endif
+#if defined(__AVX2__)
+#define FLEETVIEW_AVX2
+#include <immintrin.h>
+#endif
+
+constexpr size_t BITSINWORD = 64;
+
+void FleetView::Build(const std::vector<Car>& cars, const std::vector<CarStatus>& statuses) {
+	CostPerHour.clear();
+	Seats.clear();
+	Year.clear();
+	Status.clear();
+	for (auto& index : ValueIndexes) {
+		index.clear();
+	}
+	CostPerHour.reserve(cars.size());
+	Seats.reserve(cars.size());
+	Year.reserve(cars.size());
+	Status.reserve(cars.size());
+	for (size_t i = 0; i < cars.size(); ++i) {
+		Add(cars[i], statuses[i]);
+	}
+}
+
+void FleetView::Add(const Car& car, CarStatus status) {
+	CostPerHour.push_back(car.GetCostPerHour());
+	Seats.push_back(car.GetSeats());
+	Year.push_back(car.GetYear());
+	Status.push_back(static_cast<std::uint8_t>(status));
+
+	size_t position = Status.size() - 1;
+	const std::string values[NUMBEROFFLEETATTRIBUTES] = { car.GetMake(), car.GetModel(), car.GetMotorization(), car.GetGearbox() };
+	for (size_t i = 0; i < NUMBEROFFLEETATTRIBUTES; ++i) {
+		SelectionBitmap& selection = ValueIndexes[i][NormalizeValue(values[i])];
+		selection.resize(position / BITSINWORD + 1, 0);
+		selection[position / BITSINWORD] |= std::uint64_t(1) << (position % BITSINWORD);
+	}
+}
+
+void FleetView::SetStatus(size_t position, CarStatus status) {
+	Status[position] = static_cast<std::uint8_t>(status);
+}
+
+size_t FleetView::GetSize() const {
+	return Status.size();
+}
+
+SelectionBitmap FleetView::Select(const FleetQuery& query) const {
+	SelectionBitmap selection = query.Status ? SelectStatus(*query.Status) : SelectAll();
+	if (query.MinCostPerHour != INT_MIN || query.MaxCostPerHour != INT_MAX) {
+		Intersect(selection, SelectCostPerHour(query.MinCostPerHour, query.MaxCostPerHour));
+	}
+	if (query.MinSeats != INT_MIN || query.MaxSeats != INT_MAX) {
+		Intersect(selection, SelectSeats(query.MinSeats, query.MaxSeats));
+	}
+	if (query.MinYear != INT_MIN || query.MaxYear != INT_MAX) {
+		Intersect(selection, SelectYear(query.MinYear, query.MaxYear));
+	}
+
+	const std::pair<FleetAttribute, const std::optional<std::string>&> values[] = { { FleetAttribute::Make, query.Make },
+		{ FleetAttribute::Model, query.Model }, { FleetAttribute::Motorization, query.Motorization }, { FleetAttribute::Gearbox, query.Gearbox } };
+	for (const auto& [attribute, value] : values) {
+		if (value) {
+			Intersect(selection, SelectValue(attribute, *value));
+		}
+	}
+	return selection;
+}
+
+SelectionBitmap FleetView::SelectCostPerHour(int min, int max) const {
+	return SelectRange(CostPerHour, min, max);
+}
+
+SelectionBitmap FleetView::SelectSeats(int min, int max) const {
+	return SelectRange(Seats, min, max);
+}
+
+SelectionBitmap FleetView::SelectYear(int min, int max) const {
+	return SelectRange(Year, min, max);
+}
+
+SelectionBitmap FleetView::SelectAll() const {
+	SelectionBitmap selection((GetSize() + BITSINWORD - 1) / BITSINWORD, ~std::uint64_t(0));
+	if (GetSize() % BITSINWORD != 0) {
+		selection.back() = (std::uint64_t(1) << (GetSize() % BITSINWORD)) - 1; // The bits after the last car stay clear
+	}
+	return selection;
+}
+
+SelectionBitmap FleetView::SelectRange(const std::vector<std::int32_t>& column, int min, int max) const {
+	SelectionBitmap selection((column.size() + BITSINWORD - 1) / BITSINWORD, 0);
+	const std::int32_t* values = column.data();
+	size_t fullWords = column.size() / BITSINWORD;
+
+	for (size_t word = 0; word < fullWords; ++word) {
+		const std::int32_t* block = values + word * BITSINWORD;
+		std::uint64_t bits = 0;
+#if defined(FLEETVIEW_AVX2)
+		const __m256i low = _mm256_set1_epi32(min);
+		const __m256i high = _mm256_set1_epi32(max);
+		for (size_t i = 0; i < BITSINWORD; i += 8) {
+			__m256i value = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block + i));
+			__m256i outside = _mm256_or_si256(_mm256_cmpgt_epi32(low, value), _mm256_cmpgt_epi32(value, high));
+			std::uint64_t inside = static_cast<std::uint8_t>(~_mm256_movemask_ps(_mm256_castsi256_ps(outside)));
+			bits |= inside << i;
+		}
+#elif defined(FLEETVIEW_SSE2)
+		const __m128i low = _mm_set1_epi32(min);
+		const __m128i high = _mm_set1_epi32(max);
+		for (size_t i = 0; i < BITSINWORD; i += 4) {
+			__m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + i));
+			__m128i outside = _mm_or_si128(_mm_cmplt_epi32(value, low), _mm_cmpgt_epi32(value, high));
+			std::uint64_t inside = ~_mm_movemask_ps(_mm_castsi128_ps(outside)) & 0xF;
+			bits |= inside << i;
+		}
+#else
+		for (size_t i = 0; i < BITSINWORD; ++i) {
+			bits |= std::uint64_t(block[i] >= min && block[i] <= max) << i;
+		}
+#endif
+		selection[word] = bits;
+	}
+
+	for (size_t i = fullWords * BITSINWORD; i < column.size(); ++i) {
+		if (values[i] >= min && values[i] <= max) {
+			selection[i / BITSINWORD] |= std::uint64_t(1) << (i % BITSINWORD);
+		}
+	}
+	return selection;
+}
+
+SelectionBitmap FleetView::SelectStatus(CarStatus status) const {
+	SelectionBitmap selection((Status.size() + BITSINWORD - 1) / BITSINWORD, 0);
+	const std::uint8_t* values = Status.data();
+	const std::uint8_t wanted = static_cast<std::uint8_t>(status);
+	size_t fullWords = Status.size() / BITSINWORD;
+
+	for (size_t word = 0; word < fullWords; ++word) {
+		const std::uint8_t* block = values + word * BITSINWORD;
+		std::uint64_t bits = 0;
+#if defined(FLEETVIEW_SSE2)
+		const __m128i wantedValue = _mm_set1_epi8(static_cast<char>(wanted));
+		for (size_t i = 0; i < BITSINWORD; i += 16) {
+			__m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + i));
+			std::uint64_t equal = static_cast<std::uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(value, wantedValue)));
+			bits |= equal << i;
+		}
+#else
+		for (size_t i = 0; i < BITSINWORD; ++i) {
+			bits |= std::uint64_t(block[i] == wanted) << i;
+		}
+#endif
+		selection[word] = bits;
+	}
+
+	for (size_t i = fullWords * BITSINWORD; i < Status.size(); ++i) {
+		if (values[i] == wanted) {
+			selection[i / BITSINWORD] |= std::uint64_t(1) << (i % BITSINWORD);
+		}
+	}
+	return selection;
+}
+
+SelectionBitmap FleetView::SelectValue(FleetAttribute attribute, std::string_view value) const {
+	const auto& index = ValueIndexes[static_cast<size_t>(attribute)];
+	auto it = index.find(NormalizeValue(value));
+	if (it == index.end()) {
+		return SelectionBitmap((GetSize() + BITSINWORD - 1) / BITSINWORD, 0);
+	}
+	// The bitmap ends with the last car that has the value
+	SelectionBitmap selection = it->second;
+	selection.resize((GetSize() + BITSINWORD - 1) / BITSINWORD, 0);
+	return selection;
+}
+
+void FleetView::Sort(std::vector<size_t>& positions, FleetSortKey key, bool descending) const {
+	const std::vector<std::int32_t>* column = nullptr;
+	switch (key) {
+	case FleetSortKey::None:
+		return;
+	case FleetSortKey::CostPerHour:
+		column = &CostPerHour;
+		break;
+	case FleetSortKey::Year:
+		column = &Year;
+		break;
+	case FleetSortKey::Seats:
+		column = &Seats;
+		break;
+	}
+	const std::int32_t* values = column->data();
+	std::stable_sort(positions.begin(), positions.end(), [values, descending](size_t a, size_t b) {
+		return descending ? values[a] > values[b] : values[a] < values[b];
+		});
+}
+
+std::string FleetView::NormalizeValue(std::string_view value) {
+	std::string result(value);
+	std::transform(result.begin(), result.end(), result.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+	return result;
+}
+
+void FleetView::Intersect(SelectionBitmap& selection, const SelectionBitmap& other) {
+	size_t common = std::min(selection.size(), other.size());
+	for (size_t i = 0; i < common; ++i) {
+		selection[i] &= other[i];
+	}
+	for (size_t i = common; i < selection.size(); ++i) {
+		selection[i] = 0;
+	}
+}
+
+std::vector<size_t> FleetView::GetPositions(const SelectionBitmap& selection) {
+	std::vector<size_t> positions;
+	positions.reserve(Count(selection));
+	for (size_t word = 0; word < selection.size(); ++word) {
+		std::uint64_t bits = selection[word];
+		while (bits != 0) {
+			positions.push_back(word * BITSINWORD + std::countr_zero(bits));
+			bits &= bits - 1; // Clear the lowest set bit
+		}
+	}
+	return positions;
+}
+
+size_t FleetView::Count(const SelectionBitmap& selection) {
+	size_t count = 0;
+	for (auto bits : selection) {
+		count += std::popcount(bits);
+	}
+	return count;
+}
@@ -0,0 +1,170 @@
+#pragma once
+
+#ifndef _FLEETVIEW_H_
+#define _FLEETVIEW_H_
+
+#include <climits>
+#include <cstdint>
+#include <array>
+#include <optional>
+#include <unordered_map>
+#include "FileHandler.h"
+
+/**
+ * @brief A selection of cars, bit i (bit i % 64 of word i / 64) is set when the car on position i is selected.
+ */
+using SelectionBitmap = std::vector<std::uint64_t>;
+
+/**
+ * @brief The text attributes of the cars that have a bitmap index.
+ */
+enum class FleetAttribute { Make, Model, Motorization, Gearbox };
+
+constexpr size_t NUMBEROFFLEETATTRIBUTES = 4;
+
+/**
+ * @brief The numeric attributes the selected cars can be ordered by.
+ */
+enum class FleetSortKey { None, CostPerHour, Year, Seats };
+
+/**
+ * @brief The conditions a selected car has to meet and the order of the selected cars. All the ranges are inclusive
+ * and the text attributes are compared without regard to case.
+ */
+struct FleetQuery {
+    std::optional<std::string> Make;
+    std::optional<std::string> Model;
+    std::optional<std::string> Motorization;
+    std::optional<std::string> Gearbox;
+    int MinCostPerHour = INT_MIN;
+    int MaxCostPerHour = INT_MAX;
+    int MinSeats = INT_MIN;
+    int MaxSeats = INT_MAX;
+    int MinYear = INT_MIN;
+    int MaxYear = INT_MAX;
+    std::optional<CarStatus> Status;
+    FleetSortKey SortBy = FleetSortKey::None;
+    bool Descending = false;
+};
+
+/**
+ * @brief A columnar (struct of arrays) view of the fleet. The numeric attributes of all the cars are stored in contiguous arrays
+ * in the same order as the cars themselves, so a filter is a vectorized scan of one array that produces a selection bitmap.
+ * The text attributes have bitmap indexes (one bitmap for every value), so a text condition is a lookup and never compares strings of the cars.
+ */
+class FleetView {
+public:
+    /**
+     * @brief Discards the content of the view and fills it with the given cars.
+     * @param cars The cars of the fleet.
+     * @param statuses The statuses of the cars.
+     */
+    void Build(const std::vector<Car>& cars, const std::vector<CarStatus>& statuses);
+
+    /**
+     * @brief Adds a car at the end of the view.
+     * @param car The added car.
+     * @param status The status of the added car.
+     */
+    void Add(const Car& car, CarStatus status);
+
+    /**
+     * @brief Changes the status of the car on the given position.
+     * @param position The position of the car.
+     * @param status The new status of the car.
+     */
+    void SetStatus(size_t position, CarStatus status);
+
+    /**
+     * @brief Retrieves the number of cars in the view.
+     * @return The number of cars.
+     */
+    size_t GetSize() const;
+
+    /**
+     * @brief Selects the cars that meet all the conditions of the query.
+     * @param query The conditions.
+     * @return The selection bitmap.
+     */
+    SelectionBitmap Select(const FleetQuery& query) const;
+
+    /**
+     * @brief Selects the cars with the cost per hour in the given range.
+     */
+    SelectionBitmap SelectCostPerHour(int min, int max) const;
+
+    /**
+     * @brief Selects the cars with the number of seats in the given range.
+     */
+    SelectionBitmap SelectSeats(int min, int max) const;
+
+    /**
+     * @brief Selects the cars with the year of manufacture in the given range.
+     */
+    SelectionBitmap SelectYear(int min, int max) const;
+
+    /**
+     * @brief Selects the cars with the given status.
+     */
+    SelectionBitmap SelectStatus(CarStatus status) const;
+
+    /**
+     * @brief Selects the cars with the given value of a text attribute from its bitmap index.
+     * @param attribute The attribute.
+     * @param value The value, compared without regard to case.
+     */
+    SelectionBitmap SelectValue(FleetAttribute attribute, std::string_view value) const;
+
+    /**
+     * @brief Orders the positions of the cars by a numeric attribute, the cars with equal values stay in their order.
+     * @param positions The positions of the cars.
+     * @param key The attribute to order by, FleetSortKey::None keeps the order.
+     * @param descending True to order from the highest value.
+     */
+    void Sort(std::vector<size_t>& positions, FleetSortKey key, bool descending) const;
+
+    /**
+     * @brief Creates a bitmap that selects all the cars.
+     */
+    SelectionBitmap SelectAll() const;
+
+    /**
+     * @brief Intersects two selections, the result is stored to the first one.
+     * @param selection The first selection and the result.
+     * @param other The second selection.
+     */
+    static void Intersect(SelectionBitmap& selection, const SelectionBitmap& other);
+
+    /**
+     * @brief Converts a selection to the positions of the selected cars.
+     * @param selection The selection.
+     * @return The positions of the selected cars in ascending order.
+     */
+    static std::vector<size_t> GetPositions(const SelectionBitmap& selection);
+
+    /**
+     * @brief Counts the selected cars.
+     * @param selection The selection.
+     * @return The number of the selected cars.
+     */
+    static size_t Count(const SelectionBitmap& selection);
+
+private:
+    /**
+     * @brief The vectorized kernel selecting the values of a column that are in the given range.
+     */
+    SelectionBitmap SelectRange(const std::vector<std::int32_t>& column, int min, int max) const;
+
+    /**
+     * @brief Converts a value of a text attribute to its key in the bitmap index (lower case).
+     */
+    static std::string NormalizeValue(std::string_view value);
+
+    std::vector<std::int32_t> CostPerHour;
+    std::vector<std::int32_t> Seats;
+    std::vector<std::int32_t> Year;
+    std::vector<std::uint8_t> Status;
+    std::array<std::unordered_map<std::string, SelectionBitmap>, NUMBEROFFLEETATTRIBUTES> ValueIndexes; // Normalized value -> the cars with it, for every text attribute
+};
+
+#endif // !_FLEETVIEW_H_
@@ -0,0 +1,87 @@
+#include "FrameRenderer.h"
+#include <algorithm>
+#include <cstring>
+#include <cstdlib>
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#endif
+
+// Every thread builds its own frames, so the sessions of the server do not share them
+static thread_local std::string Frame; // The frame being built, its capacity is kept for the next frames
+static thread_local size_t Depth = 0; // The number of frames being built
+static thread_local bool ClearRequested = false;
+static std::atomic<bool> ClearingEnabled = true;
+
+#ifdef _WIN32
+/**
+ * @brief Lets the Windows console interpret the ANSI escape sequences (it does not by default).
+ * @return False if the console does not support them.
+ */
+static bool EnableVirtualTerminal() {
+	HANDLE console = GetStdHandle(STD_OUTPUT_HANDLE);
+	DWORD mode = 0;
+	return console != INVALID_HANDLE_VALUE && GetConsoleMode(console, &mode) && SetConsoleMode(console, mode | ENABLE_VIRTUAL_TERMINAL_PROCESSING);
+}
+#endif
+
+std::ostream& operator<<(std::ostream& os, Padding padding) {
+	char chunk[64];
+	std::memset(chunk, padding.Fill, sizeof(chunk));
+	for (size_t left = padding.Count; left > 0;) {
+		size_t count = std::min(left, sizeof(chunk));
+		os.write(chunk, count);
+		left -= count;
+	}
+	return os;
+}
+
+FrameRenderer::FrameRenderer(std::ostream& output) : std::ostream(nullptr), Output(output), Outermost(Depth == 0) {
+	rdbuf(&Buffer);
+	++Depth;
+	if (Outermost) {
+		Frame.clear();
+		if (ClearRequested) {
+			Frame += CLEARSCREENSEQUENCE;
+			ClearRequested = false;
+		}
+	}
+}
+
+FrameRenderer::~FrameRenderer() {
+	--Depth;
+	if (Outermost) {
+		Output.write(Frame.data(), Frame.size());
+		Output.flush();
+	}
+}
+
+void FrameRenderer::RequestClear() {
+	if (!ClearingEnabled.load(std::memory_order_relaxed)) {
+		return;
+	}
+#ifdef _WIN32
+	static const bool virtualTerminal = EnableVirtualTerminal();
+	if (!virtualTerminal) {
+		std::system("cls"); // An old console, which cannot be cleared by the escape sequence
+		return;
+	}
+#endif
+	ClearRequested = true;
+}
+
+void FrameRenderer::SetClearing(bool enabled) {
+	ClearingEnabled = enabled;
+}
+
+FrameRenderer::FrameBuffer::int_type FrameRenderer::FrameBuffer::overflow(int_type character) {
+	if (!traits_type::eq_int_type(character, traits_type::eof())) {
+		Frame += traits_type::to_char_type(character);
+	}
+	return traits_type::not_eof(character);
+}
+
+std::streamsize FrameRenderer::FrameBuffer::xsputn(const char* text, std::streamsize count) {
+	Frame.append(text, static_cast<size_t>(count));
+	return count;
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#ifndef _FRAMERENDERER_H_
+#define _FRAMERENDERER_H_
+
+#include <atomic>
+#include <ostream>
+#include <streambuf>
+#include <string>
+
+/**
+ * @brief The ANSI escape sequence that moves the cursor home and clears the screen and the scrollback.
+ */
+constexpr char CLEARSCREENSEQUENCE[] = "\x1b[H\x1b[2J\x1b[3J";
+
+/**
+ * @brief Padding written to a stream without creating a temporary string, for example os << Padding(spacing) << title.
+ */
+struct Padding {
+    explicit Padding(size_t count, char fill = ' ') : Count(count), Fill(fill) {}
+
+    size_t Count;
+    char Fill;
+};
+
+std::ostream& operator<<(std::ostream& os, Padding padding);
+
+/**
+ * @brief A stream that builds one screen (frame) in a buffer reused by all the frames and writes it to the output
+ * in a single write when the frame is destroyed, so the screen is never shown half drawn.
+ * A requested clear of the console is written at the beginning of the next frame.
+ * A frame created while another one is being built (on the same thread) is part of the outer frame.
+ */
+class FrameRenderer : public std::ostream {
+public:
+    /**
+     * @brief Starts a frame.
+     * @param output The stream the frame is written to.
+     */
+    explicit FrameRenderer(std::ostream& output);
+
+    /**
+     * @brief Writes the frame to the output.
+     */
+    ~FrameRenderer();
+
+    FrameRenderer(const FrameRenderer&) = delete;
+    FrameRenderer& operator=(const FrameRenderer&) = delete;
+
+    /**
+     * @brief Clears the console at the beginning of the next frame.
+     */
+    static void RequestClear();
+
+    /**
+     * @brief Turns clearing the console on or off for all the threads, for example off while replaying recorded sessions.
+     * Clearing is on by default.
+     * @param enabled False to ignore the requested clears.
+     */
+    static void SetClearing(bool enabled);
+
+private:
+    /**
+     * @brief Appends everything written to the frame to the shared buffer, flushing it does nothing.
+     */
+    class FrameBuffer : public std::streambuf {
+    protected:
+        int_type overflow(int_type character) override;
+        std::streamsize xsputn(const char* text, std::streamsize count) override;
+    };
+
+    std::ostream& Output;
+    FrameBuffer Buffer;
+    bool Outermost;
+};
+
+#endif // !_FRAMERENDERER_H_
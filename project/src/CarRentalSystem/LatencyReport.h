@@ -0,0 +1,78 @@
+#pragma once
+
+#ifndef _LATENCYREPORT_H_
+#define _LATENCYREPORT_H_
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * @brief The number and percentiles of measured latencies (in microseconds), as the benchmark and the replay of the sessions report them.
+ */
+struct LatencySummary {
+    size_t Samples = 0;
+    double P50 = 0;
+    double P90 = 0;
+    double P99 = 0;
+    double Max = 0;
+};
+
+/**
+ * @brief Retrieves the given percentile of sorted latencies by the nearest rank.
+ */
+inline double GetPercentile(const std::vector<double>& sorted, double percentile) {
+    size_t rank = static_cast<size_t>(std::ceil(percentile / 100 * sorted.size()));
+    return sorted[std::clamp<size_t>(rank, 1, sorted.size()) - 1];
+}
+
+/**
+ * @brief Sorts the latencies and summarizes them.
+ * @param latencies The latencies, there has to be at least one.
+ */
+inline LatencySummary SummarizeLatencies(std::vector<double>& latencies) {
+    std::sort(latencies.begin(), latencies.end());
+    LatencySummary summary;
+    summary.Samples = latencies.size();
+    summary.P50 = GetPercentile(latencies, 50);
+    summary.P90 = GetPercentile(latencies, 90);
+    summary.P99 = GetPercentile(latencies, 99);
+    summary.Max = latencies.back();
+    return summary;
+}
+
+/**
+ * @brief Prints the header of a table of latencies with one row for every operation (see PrintLatencyRow).
+ * @param os The stream to print to.
+ * @param name The title of the column of the names of the operations.
+ * @param samples The title of the column of the numbers of samples.
+ * @param throughput True to add the column of the operations per second.
+ */
+inline void PrintLatencyHeader(std::ostream& os, const char* name, const char* samples, bool throughput) {
+    os << std::left << std::setw(20) << name << std::right << std::setw(9) << samples;
+    if (throughput) {
+        os << std::setw(14) << "OPS/S";
+    }
+    os << std::setw(12) << "P50 US" << std::setw(12) << "P90 US" << std::setw(12) << "P99 US" << std::setw(12) << "MAX US" << std::endl;
+}
+
+/**
+ * @brief Prints one row of a table of latencies.
+ * @param os The stream to print to.
+ * @param name The name of the operation.
+ * @param latencies The latencies of the operation.
+ * @param opsPerSecond The throughput of the operation, std::nullopt if the table has no column for it.
+ */
+inline void PrintLatencyRow(std::ostream& os, const std::string& name, const LatencySummary& latencies, std::optional<double> opsPerSecond = std::nullopt) {
+    os << std::left << std::setw(20) << name << std::right << std::setw(9) << latencies.Samples;
+    if (opsPerSecond) {
+        os << std::setw(14) << *opsPerSecond;
+    }
+    os << std::setw(12) << latencies.P50 << std::setw(12) << latencies.P90 << std::setw(12) << latencies.P99 << std::setw(12) << latencies.Max << std::endl;
+}
+
+#endif // !_LATENCYREPORT_H_
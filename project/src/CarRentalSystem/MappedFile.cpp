@@ -0,0 +1,99 @@
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile(const std::filesystem::path& filename) {
+#ifdef _WIN32
+	HANDLE file = CreateFileW(filename.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE) {
+		return;
+	}
+	FileHandle = file;
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(file, &fileSize)) {
+		return;
+	}
+	Open = true;
+	Size = static_cast<size_t>(fileSize.QuadPart);
+	if (Size == 0) {
+		return; // An empty file cannot be mapped
+	}
+
+	HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (mapping == nullptr) {
+		Open = false;
+		return;
+	}
+	MappingHandle = mapping;
+
+	Data = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+	if (Data == nullptr) {
+		Open = false;
+	}
+#else
+	FileDescriptor = open(filename.c_str(), O_RDONLY);
+	if (FileDescriptor == -1) {
+		return;
+	}
+
+	struct stat fileStatus;
+	if (fstat(FileDescriptor, &fileStatus) == -1) {
+		return;
+	}
+	Open = true;
+	Size = static_cast<size_t>(fileStatus.st_size);
+	if (Size == 0) {
+		return; // An empty file cannot be mapped
+	}
+
+	void* mapped = mmap(nullptr, Size, PROT_READ, MAP_PRIVATE, FileDescriptor, 0);
+	if (mapped == MAP_FAILED) {
+		Open = false;
+		return;
+	}
+	madvise(mapped, Size, MADV_SEQUENTIAL);
+	Data = static_cast<const char*>(mapped);
+#endif
+}
+
+MappedFile::~MappedFile() {
+#ifdef _WIN32
+	if (Data != nullptr) {
+		UnmapViewOfFile(Data);
+	}
+	if (MappingHandle != nullptr) {
+		CloseHandle(MappingHandle);
+	}
+	if (FileHandle != nullptr) {
+		CloseHandle(FileHandle);
+	}
+#else
+	if (Data != nullptr) {
+		munmap(const_cast<char*>(Data), Size);
+	}
+	if (FileDescriptor != -1) {
+		close(FileDescriptor);
+	}
+#endif
+}
+
+bool MappedFile::IsOpen() const {
+	return Open;
+}
+
+std::string_view MappedFile::GetContent() const {
+	if (Data == nullptr) {
+		return std::string_view();
+	}
+	return std::string_view(Data, Size);
+}
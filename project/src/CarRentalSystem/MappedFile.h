@@ -0,0 +1,49 @@
+#pragma once
+
+#ifndef _MAPPEDFILE_H_
+#define _MAPPEDFILE_H_
+
+#include <filesystem>
+#include <string_view>
+
+/**
+ * @brief A read-only view of a whole file mapped into memory. The file stays mapped until the object is destroyed.
+ */
+class MappedFile {
+public:
+    /**
+     * @brief Maps the given file into memory.
+     * @param filename The name of the file to map.
+     */
+    explicit MappedFile(const std::filesystem::path& filename);
+
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /**
+     * @brief Decides if the file was opened. An empty file is opened even though nothing is mapped.
+     * @return True if the file was opened.
+     */
+    bool IsOpen() const;
+
+    /**
+     * @brief Retrieves the content of the file.
+     * @return A view of the whole content of the file.
+     */
+    std::string_view GetContent() const;
+
+private:
+    bool Open = false;
+    const char* Data = nullptr;
+    size_t Size = 0;
+#ifdef _WIN32
+    void* FileHandle = nullptr;
+    void* MappingHandle = nullptr;
+#else
+    int FileDescriptor = -1;
+#endif
+};
+
+#endif // !_MAPPEDFILE_H_
@@ -0,0 +1,86 @@
+#pragma once
+
+#ifndef _MPSCQUEUE_H_
+#define _MPSCQUEUE_H_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+/**
+ * @brief A bounded lock-free queue that many threads push to and a single thread pops from.
+ * Every slot of the ring carries a sequence number: a producer claims a position by moving the tail with a compare and swap,
+ * copies the element into the slot and publishes it by advancing the sequence of the slot, so producers never wait for each other
+ * and the consumer never blocks a producer. The capacity is rounded up to a power of two.
+ */
+template <typename T>
+class MpscQueue {
+public:
+    explicit MpscQueue(size_t capacity) {
+        Capacity = 1;
+        while (Capacity < capacity) {
+            Capacity <<= 1;
+        }
+        Slots = std::make_unique<Slot[]>(Capacity);
+        for (size_t i = 0; i < Capacity; i++) {
+            Slots[i].Sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    /**
+     * @brief Adds an element, it can be called by any thread.
+     * @return False if the queue is full.
+     */
+    bool TryPush(const T& element) {
+        std::uint64_t position = Tail.load(std::memory_order_relaxed);
+        for (;;) {
+            Slot& slot = Slots[position & (Capacity - 1)];
+            std::uint64_t sequence = slot.Sequence.load(std::memory_order_acquire);
+            std::int64_t difference = static_cast<std::int64_t>(sequence - position);
+            if (difference == 0) {
+                if (Tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    slot.Element = element;
+                    slot.Sequence.store(position + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (difference < 0) {
+                return false; // The slot still holds an element the consumer has not taken
+            }
+            else {
+                position = Tail.load(std::memory_order_relaxed); // Another producer claimed the position
+            }
+        }
+    }
+
+    /**
+     * @brief Takes the oldest element, it must only be called by the consumer thread.
+     * @return False if the queue is empty (or the oldest element is still being written).
+     */
+    bool TryPop(T& element) {
+        Slot& slot = Slots[Head & (Capacity - 1)];
+        if (slot.Sequence.load(std::memory_order_acquire) != Head + 1) {
+            return false;
+        }
+        element = slot.Element;
+        slot.Sequence.store(Head + Capacity, std::memory_order_release); // Frees the slot for the producers of the next round
+        ++Head;
+        return true;
+    }
+
+private:
+    struct Slot {
+        std::atomic<std::uint64_t> Sequence;
+        T Element;
+    };
+
+    std::unique_ptr<Slot[]> Slots;
+    size_t Capacity;
+    alignas(64) std::atomic<std::uint64_t> Tail = 0; // The next position claimed by a producer
+    alignas(64) std::uint64_t Head = 0; // The next position taken by the consumer
+};
+
+#endif // !_MPSCQUEUE_H_
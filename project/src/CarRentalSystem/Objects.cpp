@@ -1,34 +1,133 @@
 #include "Objects.h"
+#include "Schema.h"
+#include <charconv>
+#include <mutex>
+#include <limits>
+#include <cstring>
+
+StringDictionary Car::Makes(std::numeric_limits<std::uint16_t>::max());
+StringDictionary Car::Models(std::numeric_limits<std::uint16_t>::max());
+StringDictionary Car::Colors(std::numeric_limits<std::uint16_t>::max());
+// The known types have to be in the same order as in MotorizationType and GearboxType
+StringDictionary Car::Motorizations(std::numeric_limits<std::uint8_t>::max(), { "Gasoline", "Diesel", "Hybrid", "Plug-in hybrid", "Electric", "LPG", "CNG", "Hydrogen" });
+StringDictionary Car::Gearboxes(std::numeric_limits<std::uint8_t>::max(), { "Manual", "Automatic", "Semi-automatic" });
+
+/**
+ * @brief Converts a number to a narrower type.
+ * @throws std::out_of_range if the number does not fit.
+ */
+template <typename T>
+static T Narrow(int value) {
+    if (value < std::numeric_limits<T>::min() || value > std::numeric_limits<T>::max()) {
+        throw std::out_of_range(PROPERTYOUTOFRANGEMESSAGE);
+    }
+    return static_cast<T>(value);
+}
 
+StringDictionary::StringDictionary(size_t maxSize, std::initializer_list<std::string_view> predefined) : MaxSize(maxSize) {
+    for (auto text : predefined) {
+        Encode(text);
+    }
+}
 
-Car::Car(const Properties& props) {
-    if (props.size() != 9) {
-        throw std::invalid_argument(INVALIDNUMBEROFPROPERTIESMESSAGE);
+std::uint16_t StringDictionary::Encode(std::string_view text) {
+    {
+        std::shared_lock<std::shared_mutex> lock(Mutex);
+        auto it = Ids.find(text);
+        if (it != Ids.end()) {
+            return it->second;
+        }
     }
-    Make = props[0];
-    Model = props[1];
-    Year = std::stoi(props[2]);
-    Color = props[3];
-    LicencePlate = props[4];
-    Motorization = props[5];
-    Gearbox = props[6];
-    Seats = std::stoi(props[7]);
-    CostPerHour = std::stoi(props[8]);
+    std::unique_lock<std::shared_mutex> lock(Mutex);
+    auto it = Ids.find(text); // Another thread could have added it in the meantime
+    if (it != Ids.end()) {
+        return it->second;
+    }
+    if (Strings.size() >= MaxSize) {
+        throw std::length_error(DICTIONARYFULLMESSAGE);
+    }
+    Strings.emplace_back(text);
+    std::uint16_t id = static_cast<std::uint16_t>(Strings.size() - 1);
+    Ids.emplace(Strings.back(), id);
+    return id;
 }
 
-Properties Car::GetProperties() const {
-    Properties result = { Make,Model,std::to_string(Year),Color,
-        LicencePlate,Motorization,Gearbox,
-        std::to_string(Seats), std::to_string(CostPerHour) };
+std::string_view StringDictionary::Decode(std::uint16_t id) const {
+    std::shared_lock<std::shared_mutex> lock(Mutex);
+    return Strings[id];
+}
+
+
+/**
+ * @brief Converts the number at the beginning of the property.
+ * @return The error of std::from_chars, std::errc::invalid_argument if there is no number.
+ */
+static std::errc ConvertNumber(std::string_view text, int& result) {
+    size_t start = text.find_first_not_of(" \t");
+    if (start == std::string_view::npos) {
+        return std::errc::invalid_argument;
+    }
+    if (text[start] == '+') {
+        ++start;
+    }
+    return std::from_chars(text.data() + start, text.data() + text.size(), result).ec;
+}
+
+int ParseNumber(std::string_view text) {
+    int result = 0;
+    std::errc error = ConvertNumber(text, result);
+    if (error == std::errc::result_out_of_range) {
+        throw std::out_of_range(std::string(text));
+    }
+    if (error != std::errc()) {
+        throw std::invalid_argument(std::string(text));
+    }
     return result;
 }
 
+bool TryParseNumber(std::string_view text, int& result) {
+    int number = 0;
+    if (ConvertNumber(text, number) != std::errc()) {
+        return false;
+    }
+    result = number;
+    return true;
+}
+
+Car::Car(const Properties& props) : Car(std::vector<std::string_view>(props.begin(), props.end())) {
+}
+
+Car::Car(PropertyViews props) : Car(ParseRecordOrThrow<Car>(props)) {
+}
+
+Car::Car(std::string_view make, std::string_view model, int year, std::string_view color, std::string_view licencePlate,
+    std::string_view motorization, std::string_view gearbox, int seats, int costPerHour) {
+    if (licencePlate.size() > MAXLICENCEPLATELENGTH) {
+        throw std::invalid_argument(LICENCEPLATETOOLONGMESSAGE);
+    }
+    LicencePlate.fill('\0');
+    std::memcpy(LicencePlate.data(), licencePlate.data(), licencePlate.size());
+    LicencePlateLength = static_cast<std::uint8_t>(licencePlate.size());
+    Year = Narrow<YearType>(year);
+    Seats = Narrow<SeatsType>(seats);
+    CostPerHour = Narrow<CostPerHourType>(costPerHour);
+    Make = Makes.Encode(make);
+    Model = Models.Encode(model);
+    Color = Colors.Encode(color);
+    Motorization = static_cast<std::uint8_t>(Motorizations.Encode(motorization));
+    Gearbox = static_cast<std::uint8_t>(Gearboxes.Encode(gearbox));
+}
+
+Properties Car::GetProperties() const {
+    return ToProperties(*this);
+}
+
 std::string Car::GetMake() const {
-    return Make;
+    return std::string(Makes.Decode(Make));
 }
 
 std::string Car::GetModel() const {
-    return Model;
+    return std::string(Models.Decode(Model));
 }
 
 int Car::GetYear() const {
@@ -36,19 +135,19 @@ int Car::GetYear() const {
 }
 
 std::string Car::GetColor() const {
-    return Color;
+    return std::string(Colors.Decode(Color));
 }
 
 std::string Car::GetLicencePlate() const {
-    return LicencePlate;
+    return std::string(LicencePlate.data(), LicencePlateLength);
 }
 
 std::string Car::GetMotorization() const {
-    return Motorization;
+    return std::string(Motorizations.Decode(Motorization));
 }
 
 std::string Car::GetGearbox() const {
-    return Gearbox;
+    return std::string(Gearboxes.Decode(Gearbox));
 }
 
 int Car::GetSeats() const {
@@ -59,67 +158,77 @@ int Car::GetCostPerHour() const {
     return CostPerHour;
 }
 
+MotorizationType Car::GetMotorizationType() const {
+    if (Motorization >= static_cast<std::uint8_t>(MotorizationType::Other)) {
+        return MotorizationType::Other;
+    }
+    return static_cast<MotorizationType>(Motorization);
+}
 
-Customer::Customer(const Properties& props) {
-    if (props.size() != 5) {
-        throw std::invalid_argument(INVALIDNUMBEROFPROPERTIESMESSAGE);
+GearboxType Car::GetGearboxType() const {
+    if (Gearbox >= static_cast<std::uint8_t>(GearboxType::Other)) {
+        return GearboxType::Other;
     }
-    Name = props[0];
-    Surname = props[1];
-    EmailAdress = props[2];
-    Phone = props[3];
-    Adress = props[4];
+    return static_cast<GearboxType>(Gearbox);
+}
+
+
+Customer::Customer(const Properties& props) : Customer(std::vector<std::string_view>(props.begin(), props.end())) {
+}
+
+Customer::Customer(PropertyViews props, std::pmr::memory_resource* resource) : Customer(ParseRecordOrThrow<Customer>(props, resource)) {
+}
+
+Customer::Customer(std::string_view name, std::string_view surname, std::string_view emailAdress, std::string_view phone, std::string_view adress,
+    std::pmr::memory_resource* resource)
+    : Name(name, resource), Surname(surname, resource), EmailAdress(emailAdress, resource), Phone(phone, resource), Adress(adress, resource) {
 }
 
 Properties Customer::GetProperties() const {
-    Properties result = { Name,Surname,EmailAdress,Phone,Adress };
-    return result;
+    return ToProperties(*this);
 }
 
 std::string Customer::GetName() const {
-    return Name;
+    return std::string(Name);
 }
 
 std::string Customer::GetSurname() const {
-    return Surname;
+    return std::string(Surname);
 }
 
 std::string Customer::GetEmailAdress() const {
-    return EmailAdress;
+    return std::string(EmailAdress);
 }
 
 std::string Customer::GetPhone() const {
-    return Phone;
+    return std::string(Phone);
 }
 
 std::string Customer::GetAdress() const {
-    return Adress;
+    return std::string(Adress);
 }
 
 
-User::User(const Properties& props) {
-    if (props.size() != 3) {
-        throw std::invalid_argument(INVALIDNUMBEROFPROPERTIESMESSAGE);
-    }
-    Username = props[0];
-    Password = props[1];
-    if (props[2] == "1") {
-        Admin = true;
-    }
-    else {
-        Admin = false;
-    }
+User::User(const Properties& props) : User(std::vector<std::string_view>(props.begin(), props.end())) {
+}
+
+User::User(PropertyViews props, std::pmr::memory_resource* resource) : User(ParseRecordOrThrow<User>(props, resource)) {
+}
+
+User::User(std::string_view username, std::string_view password, bool admin, std::pmr::memory_resource* resource)
+    : Username(username, resource), Password(password, resource), Admin(admin) {
 }
 
 Properties User::GetProperties() const {
-    Properties result = { Username,Password};
-    if (Admin) {
-        result.push_back("1");
-    }
-    else {
-        result.push_back("0");
-    }
-    return result;
+    return ToProperties(*this);
+}
+
+std::string User::GetUsername() const {
+    return std::string(Username);
+}
+
+std::string User::GetPassword() const {
+    return std::string(Password);
 }
 
 bool User::GetAdminStatus() const{
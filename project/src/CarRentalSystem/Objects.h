@@ -4,7 +4,15 @@
 #define _OBJECTS_H_
 
 #include <string>
+#include <string_view>
+#include <span>
 #include <vector>
+#include <deque>
+#include <array>
+#include <cstdint>
+#include <unordered_map>
+#include <shared_mutex>
+#include <memory_resource>
 #include <stdexcept>
 
 /**
@@ -12,13 +20,98 @@
  */
 using Properties = std::vector<std::string>;
 
+/**
+ * @brief Non-owning views of the properties of either a car, a customer, or a user (for example pointing into a mapped file).
+ */
+using PropertyViews = std::span<const std::string_view>;
+
 constexpr char INVALIDNUMBEROFPROPERTIESMESSAGE[] = "Invalid number of properties";
 
+/**
+ * @brief The position of the licence plate in the properties of a car.
+ */
+constexpr size_t LICENCEPLATEPOSITION = 4;
+
+/**
+ * @brief Converts a property to a number the same way std::stoi does, but without creating a string.
+ * @param text The property to convert.
+ * @return The number.
+ * @throws std::invalid_argument if the property does not start with a number.
+ */
+int ParseNumber(std::string_view text);
+
+/**
+ * @brief Converts a property to a number the same way as ParseNumber, but reports a failure instead of throwing.
+ * @param text The property to convert.
+ * @param result The number, left untouched on failure.
+ * @return True if the property starts with a number that fits into int.
+ */
+bool TryParseNumber(std::string_view text, int& result);
+
+/**
+ * @brief The longest licence plate a car can have.
+ */
+constexpr size_t MAXLICENCEPLATELENGTH = 15;
+
+constexpr char LICENCEPLATETOOLONGMESSAGE[] = "Licence plate is too long";
+constexpr char PROPERTYOUTOFRANGEMESSAGE[] = "Property is out of range";
+constexpr char DICTIONARYFULLMESSAGE[] = "Too many different values of a property";
+
+/**
+ * @brief Stores every distinct string only once and identifies it by a small number (dictionary encoding).
+ * Identifiers are never reused, so they stay valid for the whole run of the program.
+ */
+class StringDictionary {
+public:
+    /**
+     * @brief Constructs a dictionary.
+     * @param maxSize The maximum number of distinct strings.
+     * @param predefined Strings that get the identifiers 0, 1, 2, ... in the given order.
+     */
+    StringDictionary(size_t maxSize, std::initializer_list<std::string_view> predefined = {});
+
+    /**
+     * @brief Returns the identifier of the string, the string is added if it is not in the dictionary yet.
+     * @param text The string to encode.
+     * @return The identifier of the string.
+     * @throws std::length_error if the dictionary is full.
+     */
+    std::uint16_t Encode(std::string_view text);
+
+    /**
+     * @brief Returns the string with the given identifier.
+     * @param id The identifier returned by Encode.
+     * @return A view of the string, valid for the whole run of the program.
+     */
+    std::string_view Decode(std::uint16_t id) const;
+
+private:
+    size_t MaxSize;
+    std::deque<std::string> Strings; // A deque never moves its elements, so the views below stay valid
+    std::unordered_map<std::string_view, std::uint16_t> Ids;
+    mutable std::shared_mutex Mutex;
+};
+
+/**
+ * @brief The known types of motorization, any other motorization of a car is Other.
+ */
+enum class MotorizationType : std::uint8_t { Gasoline, Diesel, Hybrid, PlugInHybrid, Electric, LPG, CNG, Hydrogen, Other };
+
+/**
+ * @brief The known types of gearbox, any other gearbox of a car is Other.
+ */
+enum class GearboxType : std::uint8_t { Manual, Automatic, SemiAutomatic, Other };
+
 /**
  * @brief Represents a car with various attributes such as make, model, year, etc.
  */
 class Car {
 public:
+    // The types the numbers are stored in, they also limit the values accepted by the parser
+    using YearType = std::int16_t;
+    using SeatsType = std::uint8_t;
+    using CostPerHourType = std::uint16_t;
+
     /**
      * @brief Constructs a Car object from a vector of properties.
      * @param props A vector containing car properties.
@@ -26,6 +119,19 @@ public:
      */
     Car(const Properties& props);
 
+    /**
+     * @brief Constructs a Car object from views of its properties. The viewed strings are copied.
+     * @param props Views of the car properties.
+     * @throws std::invalid_argument if the number of properties is incorrect or a property is invalid.
+     */
+    Car(PropertyViews props);
+
+    /**
+     * @brief Constructs a Car object from its already parsed attributes (for example from a binary snapshot).
+     */
+    Car(std::string_view make, std::string_view model, int year, std::string_view color, std::string_view licencePlate,
+        std::string_view motorization, std::string_view gearbox, int seats, int costPerHour);
+
     /**
      * @brief Retrieves the properties of the car.
      * @return A vector containing the car's properties.
@@ -86,16 +192,37 @@ public:
      */
     int GetCostPerHour() const;
 
+    /**
+     * @brief Retrieves the motorization type of the car as an enum.
+     * @return The motorization type, Other if it is not one of the known types.
+     */
+    MotorizationType GetMotorizationType() const;
+
+    /**
+     * @brief Retrieves the gearbox type of the car as an enum.
+     * @return The gearbox type, Other if it is not one of the known types.
+     */
+    GearboxType GetGearboxType() const;
+
 private:
-    std::string Make;
-    std::string Model;
-    int Year;
-    std::string Color;
-    std::string LicencePlate;
-    std::string Motorization;
-    std::string Gearbox;
-    int Seats;
-    int CostPerHour;
+    // The car is packed into a few bytes: the repeating strings are dictionary-encoded,
+    // the licence plate is stored inline and the numbers are narrowed.
+    std::array<char, MAXLICENCEPLATELENGTH> LicencePlate;
+    std::uint8_t LicencePlateLength;
+    std::uint16_t Make;
+    std::uint16_t Model;
+    std::uint16_t Color;
+    YearType Year;
+    CostPerHourType CostPerHour;
+    SeatsType Seats;
+    std::uint8_t Motorization; // Identifiers below MotorizationType::Other are the known types
+    std::uint8_t Gearbox; // Identifiers below GearboxType::Other are the known types
+
+    static StringDictionary Makes;
+    static StringDictionary Models;
+    static StringDictionary Colors;
+    static StringDictionary Motorizations;
+    static StringDictionary Gearboxes;
 };
 
 /**
@@ -110,6 +237,20 @@ public:
      */
     Customer(const Properties& props);
 
+    /**
+     * @brief Constructs a Customer object from views of its properties. The viewed strings are copied.
+     * @param props Views of the customer properties.
+     * @param resource The memory resource the strings are allocated from (for example the arena of a bulk load).
+     * @throws std::invalid_argument if the number of properties is incorrect.
+     */
+    Customer(PropertyViews props, std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+    /**
+     * @brief Constructs a Customer object from its attributes. The viewed strings are copied.
+     */
+    Customer(std::string_view name, std::string_view surname, std::string_view emailAdress, std::string_view phone, std::string_view adress,
+        std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
     /**
      * @brief Retrieves the properties of the customer.
      * @return A vector containing the customer's properties.
@@ -147,11 +288,12 @@ public:
     std::string GetAdress() const;
 
 private:
-    std::string Name;
-    std::string Surname;
-    std::string EmailAdress;
-    std::string Phone; // The phone number is represented as a string in case the customer provided their number with the country code where there is a +.
-    std::string Adress;
+    // A copy of a customer allocates its strings from the default resource, so only the loaded customers live in an arena
+    std::pmr::string Name;
+    std::pmr::string Surname;
+    std::pmr::string EmailAdress;
+    std::pmr::string Phone; // The phone number is represented as a string in case the customer provided their number with the country code where there is a +.
+    std::pmr::string Adress;
 };
 
 /**
@@ -166,12 +308,37 @@ public:
      */
     User(const Properties& props);
 
+    /**
+     * @brief Constructs a User object from views of its properties. The viewed strings are copied.
+     * @param props Views of the user properties.
+     * @param resource The memory resource the strings are allocated from (for example the arena of a bulk load).
+     * @throws std::invalid_argument if the number of properties is incorrect.
+     */
+    User(PropertyViews props, std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+    /**
+     * @brief Constructs a User object from its attributes. The viewed strings are copied.
+     */
+    User(std::string_view username, std::string_view password, bool admin, std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
     /**
      * @brief Retrieves the properties of the user.
      * @return A vector containing the user's properties.
      */
     Properties GetProperties() const;
 
+    /**
+     * @brief Retrieves the username of the user.
+     * @return A string representing the user's username.
+     */
+    std::string GetUsername() const;
+
+    /**
+     * @brief Retrieves the password of the user.
+     * @return A string representing the user's password.
+     */
+    std::string GetPassword() const;
+
     /**
      * @brief Retrieves the admin status of the user.
      * @return A boolean indicating whether the user is an admin.
@@ -179,8 +346,8 @@ public:
     bool GetAdminStatus() const;
 
 private:
-    std::string Username;
-    std::string Password;
+    std::pmr::string Username;
+    std::pmr::string Password;
     bool Admin;
 };
 
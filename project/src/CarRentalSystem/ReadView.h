@@ -0,0 +1,81 @@
+#pragma once
+
+#ifndef _READVIEW_H_
+#define _READVIEW_H_
+
+#include <atomic>
+#include <memory>
+#include "ContractLedger.h"
+
+/**
+ * @brief The number of the elements of a chunk of a CowVector, which is also the most a change copies.
+ */
+constexpr size_t READVIEWCHUNKSIZE = 1024;
+
+/**
+ * @brief A vector whose elements are kept in chunks shared by the copies of the vector. Copying the vector only copies the pointers
+ * to its chunks, a change copies the changed chunk first if any copy still uses it (copy-on-write), otherwise it changes it in place.
+ * A copy is never changed by the changes of the vector it was copied from, so it can be read without any lock.
+ */
+template <typename T>
+class CowVector {
+public:
+    size_t size() const {
+        return Size;
+    }
+
+    const T& operator[](size_t position) const {
+        return (*Chunks[position / READVIEWCHUNKSIZE])[position % READVIEWCHUNKSIZE];
+    }
+
+    void push_back(T value) {
+        if (Size % READVIEWCHUNKSIZE == 0) {
+            auto chunk = std::make_shared<std::vector<T>>();
+            chunk->reserve(READVIEWCHUNKSIZE);
+            Chunks.push_back(std::move(chunk));
+        }
+        GetWritableChunk(Chunks.size() - 1).push_back(std::move(value));
+        ++Size;
+    }
+
+    void set(size_t position, T value) {
+        GetWritableChunk(position / READVIEWCHUNKSIZE)[position % READVIEWCHUNKSIZE] = std::move(value);
+    }
+
+    void clear() {
+        Chunks.clear();
+        Size = 0;
+    }
+
+private:
+    std::vector<T>& GetWritableChunk(size_t chunk) {
+        // Only a copy can hold the chunk besides this vector and a copy is only made from this vector, so the count cannot grow meanwhile
+        if (Chunks[chunk].use_count() > 1) {
+            auto copy = std::make_shared<std::vector<T>>();
+            copy->reserve(READVIEWCHUNKSIZE);
+            copy->assign(Chunks[chunk]->begin(), Chunks[chunk]->end());
+            Chunks[chunk] = std::move(copy);
+        }
+        else {
+            std::atomic_thread_fence(std::memory_order_acquire); // The reads of the released copies happen before the change
+        }
+        return *Chunks[chunk];
+    }
+
+    std::vector<std::shared_ptr<std::vector<T>>> Chunks;
+    size_t Size = 0;
+};
+
+/**
+ * @brief A consistent point-in-time view of the cars, customers and contracts, which is never changed once it is taken.
+ * The views share all the data that has not changed since, a view is freed (with the data only it uses) when its last reader drops it.
+ */
+struct ReadView {
+    std::chrono::system_clock::time_point Taken; // When the view was taken
+    CowVector<Car> Cars;
+    CowVector<CarStatus> CarStatuses; // CarStatuses[i] is the status of Cars[i]
+    CowVector<Customer> Customers;
+    CowVector<ContractRecord> Contracts; // Contracts[id - 1] is the contract with the identifier id
+};
+
+#endif // !_READVIEW_H_
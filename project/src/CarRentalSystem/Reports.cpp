@@ -0,0 +1,108 @@
+#include "Reports.h"
+#include "Repository.h"
+#include <map>
+
+StorageVector Reports::SummarizeRental(const ReadView& view) {
+	std::array<size_t, NUMBEROFCARSTATUSES> cars = {};
+	for (size_t i = 0; i < view.CarStatuses.size(); ++i) {
+		++cars[view.CarStatuses[i]];
+	}
+
+	size_t running = 0, reserved = 0, overdue = 0, archived = 0;
+	long long bookedRevenue = 0, revenue = 0, hours = 0;
+	for (size_t i = 0; i < view.Contracts.size(); ++i) {
+		const ContractRecord& contract = view.Contracts[i];
+		hours += contract.Hours;
+		if (contract.GetState() == ContractState::Archived) {
+			++archived;
+			revenue += contract.Price;
+			continue;
+		}
+		bookedRevenue += contract.Price;
+		if (contract.GetStart() > view.Taken) {
+			++reserved;
+		}
+		else if (contract.GetDue() < view.Taken) {
+			++overdue;
+		}
+		else {
+			++running;
+		}
+	}
+
+	return {
+		{ "ITEM", "VALUE" },
+		{ "Available cars", std::to_string(cars[CarStatus::Available]) },
+		{ "Rented cars", std::to_string(cars[CarStatus::Rented]) },
+		{ "Cars in service", std::to_string(cars[CarStatus::Serviced]) },
+		{ "Permanently unavailable cars", std::to_string(cars[CarStatus::PermanentlyUnavailable]) },
+		{ "Customers", std::to_string(view.Customers.size()) },
+		{ "Running contracts", std::to_string(running) },
+		{ "Overdue contracts", std::to_string(overdue) },
+		{ "Reservations", std::to_string(reserved) },
+		{ "Archived contracts", std::to_string(archived) },
+		{ "Revenue of the archived contracts", std::to_string(revenue) + "Kc" },
+		{ "Revenue of the active contracts", std::to_string(bookedRevenue) + "Kc" },
+		{ "Average hours of rent", std::to_string(view.Contracts.size() == 0 ? 0 : hours / static_cast<long long>(view.Contracts.size())) }
+	};
+}
+
+StorageVector Reports::SummarizeMonths(const ReadView& view) {
+	struct Month {
+		size_t Contracts = 0;
+		long long Hours = 0;
+		long long Revenue = 0;
+	};
+	std::map<std::string, Month, std::greater<>> months; // YYYY-MM sorts as a date
+	for (size_t i = 0; i < view.Contracts.size(); ++i) {
+		const ContractRecord& contract = view.Contracts[i];
+		Month& month = months[ContractLedger::FormatTime(contract.GetStart(), "%Y-%m")];
+		++month.Contracts;
+		month.Hours += contract.Hours;
+		month.Revenue += contract.Price;
+	}
+
+	StorageVector result = { { "MONTH", "CONTRACTS", "HOURS", "REVENUE" } };
+	for (const auto& [name, month] : months) {
+		result.push_back({ name, std::to_string(month.Contracts), std::to_string(month.Hours), std::to_string(month.Revenue) });
+	}
+	return result;
+}
+
+StorageVector Reports::FindTopCustomers(const ReadView& view, size_t count) {
+	struct Spending {
+		size_t Contracts = 0;
+		long long Revenue = 0;
+	};
+	std::unordered_map<std::string, Spending> spendings; // Customer key of the contracts -> spending
+	for (size_t i = 0; i < view.Contracts.size(); ++i) {
+		const ContractRecord& contract = view.Contracts[i];
+		Spending& spending = spendings[std::string(contract.GetCustomer())];
+		++spending.Contracts;
+		spending.Revenue += contract.Price;
+	}
+
+	std::vector<std::pair<std::string, Spending>> top(spendings.begin(), spendings.end());
+	count = std::min(count, top.size());
+	std::partial_sort(top.begin(), top.begin() + count, top.end(), [](const auto& a, const auto& b) { return a.second.Revenue > b.second.Revenue; });
+	top.resize(count);
+
+	// The contracts store the phone number of the customer (or the surname for the imported ones)
+	std::unordered_map<std::string, std::string> names;
+	for (const auto& [key, spending] : top) {
+		names.emplace(Repository::GetContractCustomerKey(key), key);
+	}
+	for (size_t i = 0; i < view.Customers.size(); ++i) {
+		const Customer& customer = view.Customers[i];
+		auto it = names.find(Repository::GetContractCustomerKey(customer.GetPhone()));
+		if (it != names.end()) {
+			it->second = customer.GetName() + " " + customer.GetSurname();
+		}
+	}
+
+	StorageVector result = { { "CUSTOMER", "CONTRACTS", "REVENUE" } };
+	for (const auto& [key, spending] : top) {
+		result.push_back({ names[Repository::GetContractCustomerKey(key)], std::to_string(spending.Contracts), std::to_string(spending.Revenue) });
+	}
+	return result;
+}
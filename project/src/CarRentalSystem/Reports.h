@@ -0,0 +1,42 @@
+#pragma once
+
+#ifndef _REPORTS_H_
+#define _REPORTS_H_
+
+#include "ReadView.h"
+
+/**
+ * @brief The number of the customers listed in the report of the best customers.
+ */
+constexpr size_t TOPCUSTOMERS = 5;
+
+/**
+ * @brief The aggregate reports of the rental. They are computed from a ReadView, so they never hold any lock of the repository
+ * however long they take, and they describe one moment even while the clerks keep renting.
+ */
+class Reports {
+public:
+    /**
+     * @brief Summarizes the fleet, the customers and the contracts.
+     * @param view The view to summarize.
+     * @return The rows of the summary, the first row is the header.
+     */
+    static StorageVector SummarizeRental(const ReadView& view);
+
+    /**
+     * @brief Sums the contracts by the month they started in, the latest month first.
+     * @param view The view to summarize.
+     * @return The number of contracts, the hours of rent and the revenue of every month, the first row is the header.
+     */
+    static StorageVector SummarizeMonths(const ReadView& view);
+
+    /**
+     * @brief Finds the customers who have paid the most for their contracts.
+     * @param view The view to search.
+     * @param count The maximum number of returned customers.
+     * @return The customers with their number of contracts and revenue, the first row is the header.
+     */
+    static StorageVector FindTopCustomers(const ReadView& view, size_t count);
+};
+
+#endif // !_REPORTS_H_
@@ -0,0 +1,862 @@
+#include "Repository.h"
+#include "Snapshot.h"
+#include <cctype>
+#include <limits>
+
+// The arena has to be defined before the customers and users, so that it is destroyed after them
+std::unique_ptr<std::pmr::monotonic_buffer_resource> Repository::LoadArena;
+std::vector<Car> Repository::Cars;
+std::vector<CarStatus> Repository::CarStatuses;
+std::array<std::unordered_map<std::string, size_t>, FLEETSHARDS> Repository::PlateIndex;
+std::array<std::shared_mutex, FLEETSHARDS> Repository::ShardMutexes;
+FleetView Repository::Fleet;
+std::array<std::vector<size_t>, NUMBEROFCARSTATUSES> Repository::StatusPositions;
+std::vector<size_t> Repository::CarColumnWidths;
+std::shared_mutex Repository::ListingMutex;
+std::vector<Customer> Repository::Customers;
+std::unordered_map<std::string, size_t> Repository::PhoneIndex;
+std::unordered_map<std::string, size_t> Repository::EmailIndex;
+std::vector<size_t> Repository::CustomerColumnWidths;
+std::vector<User> Repository::Users;
+ContractLedger Repository::Ledger;
+ContractTracker Repository::ActiveContracts;
+ArchiveStore Repository::Archive;
+ReservationCalendar Repository::Calendar;
+std::unordered_map<std::string, std::vector<ContractId>> Repository::ContractsByCustomer;
+std::unordered_map<std::string, std::vector<ContractId>> Repository::ContractsByPlate;
+std::multimap<std::chrono::system_clock::time_point, ContractId> Repository::ContractsByDue;
+Properties Repository::CarsHeader;
+Properties Repository::CustomersHeader;
+
+bool Repository::Snapshots = true;
+ReadView Repository::ViewHead;
+std::shared_ptr<const ReadView> Repository::LatestView;
+bool Repository::ViewChanged = false;
+bool Repository::ViewLoading = false;
+size_t Repository::OpenViewChanges = 0;
+std::mutex Repository::ViewMutex;
+std::recursive_mutex Repository::Mutex;
+
+void Repository::Load() {
+	std::lock_guard lock(Mutex);
+	{
+		// Loading the contracts moves cars, which the head of the views does not have until it is built at the end
+		std::lock_guard viewLock(ViewMutex);
+		ViewLoading = true;
+	}
+	// Everything allocated from the previous arena has to be gone before it is released
+	Customers.clear();
+	Users.clear();
+
+	// The arena is sized by the files, so the whole load usually fits in its first buffer
+	std::error_code error;
+	std::uintmax_t expectedSize = 0;
+	for (const auto& path : { CUSTOMERS, USERS }) {
+		std::uintmax_t size = std::filesystem::file_size(ConcatPaths(SOURCEFILES, path), error);
+		if (!error) {
+			expectedSize += size;
+		}
+	}
+	LoadArena = std::make_unique<std::pmr::monotonic_buffer_resource>(static_cast<size_t>(expectedSize) + 1);
+
+	{
+		// Only the cars are loaded with all the shards locked, loading the contracts locks the cars it uses
+		auto shardLocks = LockAllShards();
+		std::unique_lock listingLock(ListingMutex);
+		LoadCars();
+	}
+	LoadCustomers();
+	LoadUsers();
+	LoadContracts();
+	BuildReadView();
+}
+
+void Repository::SetSnapshots(bool enabled) {
+	std::lock_guard lock(Mutex);
+	Snapshots = enabled;
+}
+
+void Repository::LoadCars() {
+	Cars.clear();
+	CarStatuses.clear();
+	for (auto& plates : PlateIndex) {
+		plates.clear();
+	}
+
+	std::vector<std::filesystem::path> sources;
+	for (size_t i = 0; i < NUMBEROFCARSTATUSES; ++i) {
+		sources.push_back(ConcatPaths(SOURCEFILES, GetCarsPath(static_cast<CarStatus>(i))));
+	}
+	std::filesystem::path snapshot = ConcatPaths(SOURCEFILES, CARSSNAPSHOT);
+
+	if (!Snapshots || !Snapshot::IsUpToDate(snapshot, sources) || !Snapshot::LoadCars(snapshot, CarsHeader, Cars, CarStatuses)) {
+		size_t expectedCars = 0;
+		for (const auto& source : sources) {
+			expectedCars += FileReader::CountLines(source);
+		}
+		Cars.reserve(expectedCars);
+		CarStatuses.reserve(expectedCars);
+
+		// The records are parsed straight from the mapped files, the first record of every file is its header
+		bool complete = true;
+		for (size_t i = 0; i < NUMBEROFCARSTATUSES; ++i) {
+			CarStatus status = static_cast<CarStatus>(i);
+			bool header = true;
+			FileReader::ForEachRecord(sources[i], [&](PropertyViews fields) {
+				if (header) {
+					CarsHeader.assign(fields.begin(), fields.end());
+					header = false;
+					return;
+				}
+				// Empty lines (for example at the end of the file) are skipped, other records the car cannot hold are reported
+				if (std::optional<Car> car = ParseRecord<Car>(fields)) {
+					Cars.push_back(*car);
+					CarStatuses.push_back(status);
+				}
+				else if (std::any_of(fields.begin(), fields.end(), [](std::string_view field) { return !field.empty(); })) {
+					complete = false;
+					std::cerr << UNLOADEDCARMESSAGE << ' ' << sources[i].string() << ':';
+					for (std::string_view field : fields) {
+						std::cerr << ' ' << field;
+					}
+					std::cerr << std::endl;
+				}
+				});
+		}
+		// Without a snapshot the cars that were not loaded are reported again on the next start
+		if (Snapshots && complete) {
+			Snapshot::SaveCars(snapshot, CarsHeader, Cars, CarStatuses);
+		}
+	}
+
+	for (auto& positions : StatusPositions) {
+		positions.clear();
+	}
+	CarColumnWidths.clear();
+	for (const auto& name : CarsHeader) {
+		CarColumnWidths.push_back(name.size());
+	}
+	for (size_t i = 0; i < Cars.size(); ++i) {
+		PlateIndex[GetShard(Cars[i].GetLicencePlate())].emplace(Cars[i].GetLicencePlate(), i);
+		StatusPositions[CarStatuses[i]].push_back(i);
+		WidenColumns(Cars[i], CarColumnWidths);
+	}
+	Fleet.Build(Cars, CarStatuses);
+}
+
+void Repository::LoadCustomers() {
+	Customers.clear();
+	PhoneIndex.clear();
+	EmailIndex.clear();
+
+	std::filesystem::path source = ConcatPaths(SOURCEFILES, CUSTOMERS);
+	std::filesystem::path snapshot = ConcatPaths(SOURCEFILES, CUSTOMERSSNAPSHOT);
+
+	if (!Snapshots || !Snapshot::IsUpToDate(snapshot, { source }) || !Snapshot::LoadCustomers(snapshot, CustomersHeader, Customers, LoadArena.get())) {
+		Customers.reserve(FileReader::CountLines(source));
+		bool header = true;
+		FileReader::ForEachRecord(source, [&](PropertyViews fields) {
+			if (header) {
+				CustomersHeader.assign(fields.begin(), fields.end());
+				header = false;
+				return;
+			}
+			if (std::optional<Customer> customer = ParseRecord<Customer>(fields, LoadArena.get())) {
+				Customers.push_back(std::move(*customer));
+			}
+			});
+		if (Snapshots) {
+			Snapshot::SaveCustomers(snapshot, CustomersHeader, Customers);
+		}
+	}
+
+	CustomerColumnWidths.clear();
+	for (const auto& name : CustomersHeader) {
+		CustomerColumnWidths.push_back(name.size());
+	}
+	for (size_t i = 0; i < Customers.size(); ++i) {
+		IndexCustomer(i);
+		WidenColumns(Customers[i], CustomerColumnWidths);
+	}
+}
+
+void Repository::LoadUsers() {
+	Users.clear();
+
+	std::filesystem::path source = ConcatPaths(SOURCEFILES, USERS);
+	std::filesystem::path snapshot = ConcatPaths(SOURCEFILES, USERSSNAPSHOT);
+
+	if (!Snapshots || !Snapshot::IsUpToDate(snapshot, { source }) || !Snapshot::LoadUsers(snapshot, Users, LoadArena.get())) {
+		Users.reserve(FileReader::CountLines(source));
+		bool header = true;
+		FileReader::ForEachRecord(source, [&](PropertyViews fields) {
+			if (header) {
+				header = false;
+				return;
+			}
+			if (std::optional<User> user = ParseRecord<User>(fields, LoadArena.get())) {
+				Users.push_back(std::move(*user));
+			}
+			});
+		if (Snapshots) {
+			Snapshot::SaveUsers(snapshot, Users);
+		}
+	}
+}
+
+void Repository::LoadContracts() {
+	ActiveContracts.Clear();
+	Calendar.Clear();
+	ContractsByCustomer.clear();
+	ContractsByPlate.clear();
+	ContractsByDue.clear();
+
+	std::filesystem::path ledger = ConcatPaths(SOURCEFILES, CONTRACTSLEDGER);
+	std::error_code error;
+	bool existed = std::filesystem::exists(ledger, error);
+	if (!Ledger.Open(ledger)) {
+		return;
+	}
+	if (!existed) {
+		ImportLegacyContracts();
+	}
+	if (Archive.Open(ConcatPaths(SOURCEFILES, CONTRACTSARCHIVE)) && Archive.GetCount() == 0) {
+		ArchiveLedgerContracts();
+	}
+
+	for (ContractId id = 1; id <= Ledger.GetSize(); ++id) {
+		const ContractRecord* contract = Ledger.Find(id);
+		if (contract->GetState() == ContractState::Active) {
+			ActiveContracts.Add(id, contract->GetDue());
+			// A contract colliding with an earlier one (possible before the calendar existed) stays active but does not book its car
+			Calendar.Add(std::string(contract->GetLicencePlate()), id, contract->GetStart(), contract->GetDue());
+		}
+		IndexContract(id);
+	}
+	UpdateCarStatuses();
+}
+
+void Repository::IndexContract(ContractId id) {
+	const ContractRecord* contract = Ledger.Find(id);
+	ContractsByCustomer[GetContractCustomerKey(contract->GetCustomer())].push_back(id);
+	ContractsByPlate[std::string(contract->GetLicencePlate())].push_back(id);
+	ContractsByDue.emplace(contract->GetDue(), id);
+}
+
+std::string Repository::GetContractCustomerKey(std::string_view customer) {
+	std::string phone = NormalizePhone(std::string(customer));
+	return phone.empty() ? std::string(customer) : phone; // The imported contracts store the surname instead of the phone number
+}
+
+void Repository::ImportLegacyContracts() {
+	std::vector<ContractRecord> contracts;
+	std::error_code error;
+	for (ContractState state : { ContractState::Active, ContractState::Archived }) {
+		std::filesystem::path directory = ConcatPaths(SOURCEFILES, state == ContractState::Active ? ACTIVECONTRACTS : ARCHIVEDCONTRACTS);
+		if (!std::filesystem::is_directory(directory, error)) {
+			continue;
+		}
+		StorageVector names = state == ContractState::Active ? FileReader::GetActiveContracs() : FileReader::GetArchivedContracs();
+		for (const auto& name : names) {
+			if (std::optional<ContractRecord> contract = ContractLedger::ReadLegacyContract(ConcatPaths(directory, name[0] + ".txt"), state)) {
+				contracts.push_back(*contract);
+			}
+		}
+	}
+
+	// The files are left in place, they are only imported when the ledger is created
+	std::sort(contracts.begin(), contracts.end(), [](const ContractRecord& a, const ContractRecord& b) { return a.Due < b.Due; });
+	for (const auto& contract : contracts) {
+		Ledger.Append(contract);
+	}
+}
+
+void Repository::ArchiveLedgerContracts() {
+	for (ContractId id = 1; id <= Ledger.GetSize(); ++id) {
+		const ContractRecord* contract = Ledger.Find(id);
+		if (contract->GetState() == ContractState::Archived) {
+			std::string text;
+			for (const auto& line : RenderContract(*contract)) {
+				text += line + '\n';
+			}
+			Archive.Add(id, *contract, text);
+		}
+	}
+}
+
+StorageVector Repository::GetCars(CarStatus status) {
+	std::shared_lock lock(ListingMutex);
+	StorageVector result = { CarsHeader };
+	for (size_t position : StatusPositions[status]) {
+		result.push_back(Cars[position].GetProperties());
+	}
+	return result;
+}
+
+StorageVector Repository::SelectCars(const FleetQuery& query) {
+	std::shared_lock lock(ListingMutex);
+	StorageVector result = { CarsHeader };
+	std::vector<size_t> positions = FleetView::GetPositions(Fleet.Select(query));
+	Fleet.Sort(positions, query.SortBy, query.Descending);
+	for (size_t position : positions) {
+		result.push_back(Cars[position].GetProperties());
+	}
+	return result;
+}
+
+ContentPage Repository::GetCarsPage(CarStatus status, size_t page) {
+	std::shared_lock lock(ListingMutex);
+	const std::vector<size_t>& positions = StatusPositions[status];
+	ContentPage result = StartPage(CarsHeader, page, positions.size());
+	size_t first = result.Page * LISTINGPAGESIZE;
+	for (size_t i = first; i < positions.size() && i < first + LISTINGPAGESIZE; ++i) {
+		result.Rows.push_back(Cars[positions[i]].GetProperties());
+	}
+	result.ColumnWidths = CarColumnWidths;
+	return result;
+}
+
+ContentPage Repository::GetCustomersPage(size_t page) {
+	std::lock_guard lock(Mutex);
+	ContentPage result = StartPage(CustomersHeader, page, Customers.size());
+	size_t first = result.Page * LISTINGPAGESIZE;
+	for (size_t i = first; i < Customers.size() && i < first + LISTINGPAGESIZE; ++i) {
+		result.Rows.push_back(Customers[i].GetProperties());
+	}
+	result.ColumnWidths = CustomerColumnWidths;
+	return result;
+}
+
+ContentPage Repository::Paginate(const StorageVector& content, size_t page) {
+	if (content.empty()) {
+		return {};
+	}
+	ContentPage result = StartPage(content[0], page, content.size() - 1);
+	size_t first = result.Page * LISTINGPAGESIZE + 1; // After the header
+	for (size_t i = first; i < content.size() && i < first + LISTINGPAGESIZE; ++i) {
+		result.Rows.push_back(content[i]);
+	}
+	return result;
+}
+
+ContentPage Repository::StartPage(const Properties& header, size_t page, size_t recordCount) {
+	ContentPage result;
+	result.Rows.push_back(header);
+	result.PageCount = std::max<size_t>(1, (recordCount + LISTINGPAGESIZE - 1) / LISTINGPAGESIZE);
+	result.Page = std::min(page, result.PageCount - 1);
+	return result;
+}
+
+StorageVector Repository::GetCustomers() {
+	std::lock_guard lock(Mutex);
+	StorageVector result = { CustomersHeader };
+	result.reserve(Customers.size() + 1);
+	for (const auto& customer : Customers) {
+		result.push_back(customer.GetProperties());
+	}
+	return result;
+}
+
+std::optional<Car> Repository::FindCar(CarStatus status, const std::string& licencePlate) {
+	std::shared_lock lock(ShardMutexes[GetShard(licencePlate)]);
+	size_t position = FindCarPosition(status, licencePlate);
+	if (position == Cars.size()) {
+		return std::nullopt;
+	}
+	return Cars[position];
+}
+
+std::optional<CarStatus> Repository::GetCarStatus(const std::string& licencePlate) {
+	size_t shard = GetShard(licencePlate);
+	std::shared_lock lock(ShardMutexes[shard]);
+	auto it = PlateIndex[shard].find(licencePlate);
+	if (it == PlateIndex[shard].end()) {
+		return std::nullopt;
+	}
+	return CarStatuses[it->second];
+}
+
+std::optional<Customer> Repository::FindCustomer(const std::string& phoneOrEmail) {
+	std::lock_guard lock(Mutex);
+	auto it = PhoneIndex.find(NormalizePhone(phoneOrEmail));
+	if (it != PhoneIndex.end()) {
+		return Customers[it->second];
+	}
+	it = EmailIndex.find(NormalizeEmail(phoneOrEmail));
+	if (it != EmailIndex.end()) {
+		return Customers[it->second];
+	}
+	return std::nullopt;
+}
+
+std::optional<User> Repository::FindUser(const std::string& username) {
+	std::lock_guard lock(Mutex);
+	auto it = std::find_if(Users.begin(), Users.end(), [&username](const User& user) {
+		return user.GetUsername() == username;
+		});
+	if (it == Users.end()) {
+		return std::nullopt;
+	}
+	return *it;
+}
+
+bool Repository::AddCar(const Car& car, CarStatus status) {
+	// Cars may grow, so no other car can be read meanwhile
+	auto shardLocks = LockAllShards();
+	std::unique_lock listingLock(ListingMutex);
+	if (!PlateIndex[GetShard(car.GetLicencePlate())].emplace(car.GetLicencePlate(), Cars.size()).second) {
+		return false; // A second car with the plate could never be found
+	}
+	Cars.push_back(car);
+	CarStatuses.push_back(status);
+	StatusPositions[status].push_back(Cars.size() - 1);
+	WidenColumns(car, CarColumnWidths);
+	Fleet.Add(car, status);
+	ChangeReadView([&](ReadView& view) {
+		view.Cars.push_back(car);
+		view.CarStatuses.push_back(status);
+		});
+	listingLock.unlock();
+	FileWriter::AddCar(car, status);
+	return true;
+}
+
+bool Repository::AddCustomer(const Customer& customer) {
+	std::lock_guard lock(Mutex);
+	// A second customer with the phone or the e-mail could never be found, and the contracts are kept by the phone
+	std::string phone = NormalizePhone(customer.GetPhone());
+	std::string email = NormalizeEmail(customer.GetEmailAdress());
+	if ((!phone.empty() && PhoneIndex.contains(phone)) || (!email.empty() && EmailIndex.contains(email))) {
+		return false;
+	}
+	Customers.push_back(customer);
+	ChangeReadView([&](ReadView& view) { view.Customers.push_back(customer); });
+	IndexCustomer(Customers.size() - 1);
+	WidenColumns(customer, CustomerColumnWidths);
+	FileWriter::AddCustomer(customer);
+	return true;
+}
+
+void Repository::AddUser(const User& user) {
+	std::lock_guard lock(Mutex);
+	Users.push_back(user);
+	FileWriter::AddUser(user);
+}
+
+bool Repository::MoveCar(const std::string& licencePlate, CarStatus from, CarStatus to) {
+	// The status is checked and changed under the lock of the shard, so of two concurrent moves of a car only one succeeds
+	// and the files of the car are written by one move at a time
+	std::unique_lock lock(ShardMutexes[GetShard(licencePlate)]);
+	size_t position = FindCarPosition(from, licencePlate);
+	if (position == Cars.size()) {
+		return false;
+	}
+	if (from == to) {
+		return true;
+	}
+
+	CarStatuses[position] = to;
+	{
+		std::unique_lock listingLock(ListingMutex);
+		std::vector<size_t>& fromPositions = StatusPositions[from];
+		fromPositions.erase(std::lower_bound(fromPositions.begin(), fromPositions.end(), position));
+		std::vector<size_t>& toPositions = StatusPositions[to];
+		toPositions.insert(std::lower_bound(toPositions.begin(), toPositions.end(), position), position);
+		Fleet.SetStatus(position, to);
+		ChangeReadView([&](ReadView& view) { view.CarStatuses.set(position, to); });
+	}
+	FileWriter::AddCar(Cars[position], to);
+	FileWriter::DeleteRecordInFile(ConcatPaths(SOURCEFILES, GetCarsPath(from)), licencePlate, LICENCEPLATEPOSITION);
+	return true;
+}
+
+ContractId Repository::CreateContract(const Customer& customer, const Car& car, const std::chrono::system_clock::time_point& start, const std::chrono::system_clock::time_point& dueDate) {
+	std::lock_guard lock(Mutex);
+	ViewChangeScope viewChange; // The contract and the car it rents out are published together
+	// The hours and the price have to fit the 32-bit fields of the record
+	std::int64_t hours = std::chrono::duration_cast<std::chrono::hours>(dueDate - start).count();
+	std::int64_t price = hours * car.GetCostPerHour();
+	if (hours < 0 || hours > std::numeric_limits<std::int32_t>::max() || price < 0 || price > std::numeric_limits<std::int32_t>::max()) {
+		return 0;
+	}
+	std::optional<ContractRecord> contract = ContractLedger::CreateRecord(customer.GetPhone(), car.GetLicencePlate(), start, dueDate,
+		static_cast<int>(hours), static_cast<int>(price));
+	if (!contract) {
+		std::cerr << ERRORMESSAGE << std::endl;
+		return 0;
+	}
+	// The period and the calendar are checked with the times as they are stored (in whole seconds)
+	if (contract->GetDue() <= contract->GetStart() || !Calendar.IsFree(car.GetLicencePlate(), contract->GetStart(), contract->GetDue())) {
+		return 0;
+	}
+	ContractId id = Ledger.Append(*contract);
+	if (id == 0) {
+		return 0;
+	}
+	ChangeReadView([&](ReadView& view) { view.Contracts.push_back(*Ledger.Find(id)); });
+	IndexContract(id);
+	// The record is already in the ledger, so a booking the calendar refuses anyway is archived at once and never counts as active
+	if (!Calendar.Add(car.GetLicencePlate(), id, contract->GetStart(), contract->GetDue())) {
+		ArchiveContract(id);
+		return 0;
+	}
+	ActiveContracts.Add(id, dueDate);
+	UpdateCarStatuses();
+	return id;
+}
+
+bool Repository::ArchiveContract(ContractId id) {
+	std::lock_guard lock(Mutex);
+	ViewChangeScope viewChange; // The archived contract and the car it returns are published together
+	const ContractRecord* contract = Ledger.Find(id);
+	if (contract == nullptr || contract->GetState() != ContractState::Active) {
+		return false;
+	}
+
+	// The contract is archived as it is now, for example with the current name of the customer
+	ContractRecord archived = *contract;
+	archived.State = static_cast<std::uint8_t>(ContractState::Archived);
+	std::string text;
+	for (const auto& line : RenderContract(archived)) {
+		text += line + '\n';
+	}
+	if (!Archive.Add(id, archived, text) || !Ledger.SetState(id, ContractState::Archived)) {
+		return false;
+	}
+	ActiveContracts.Remove(id);
+	ChangeReadView([&](ReadView& view) { view.Contracts.set(id - 1, archived); });
+
+	std::string licencePlate(archived.GetLicencePlate());
+	Calendar.Remove(licencePlate, id, archived.GetStart());
+	std::chrono::system_clock::time_point now = std::chrono::system_clock::now();
+	bool started = archived.GetStart() <= now;
+	if (started && GetCarStatus(licencePlate) == CarStatus::Rented && Calendar.IsFree(licencePlate, now, now + std::chrono::system_clock::duration(1))) {
+		MoveCar(licencePlate, CarStatus::Rented, CarStatus::Available);
+	}
+	return true;
+}
+
+bool Repository::IsCarFree(const std::string& licencePlate, std::chrono::system_clock::time_point from, std::chrono::system_clock::time_point to) {
+	std::lock_guard lock(Mutex);
+	return Calendar.IsFree(licencePlate, from, to);
+}
+
+StorageVector Repository::FindFreeCars(std::chrono::system_clock::time_point from, std::chrono::system_clock::time_point to) {
+	std::lock_guard lock(Mutex);
+	std::shared_lock listingLock(ListingMutex);
+	StorageVector result = { CarsHeader };
+	for (CarStatus status : { CarStatus::Available, CarStatus::Rented }) {
+		for (size_t position : StatusPositions[status]) {
+			if (Calendar.IsFree(Cars[position].GetLicencePlate(), from, to)) {
+				result.push_back(Cars[position].GetProperties());
+			}
+		}
+	}
+	return result;
+}
+
+void Repository::UpdateCarStatuses() {
+	std::lock_guard lock(Mutex);
+	ViewChangeScope viewChange; // The cars whose reservations have started are published together
+	std::chrono::system_clock::time_point now = std::chrono::system_clock::now();
+	for (const auto& booking : Calendar.GetStarted(now)) {
+		const ContractRecord* contract = Ledger.Find(booking.second);
+		// A contract that is already over but was not ended leaves the car where it is
+		if (contract == nullptr || contract->GetState() != ContractState::Active || contract->GetDue() <= now) {
+			Calendar.MarkStarted(booking);
+			continue;
+		}
+		// A car that is not available yet (for example still in the repair shop) is rented by a later call,
+		// one that is rented already (for example loaded as rented) stays rented
+		std::string licencePlate(contract->GetLicencePlate());
+		if (MoveCar(licencePlate, CarStatus::Available, CarStatus::Rented)) {
+			Calendar.MarkStarted(booking);
+			continue;
+		}
+		std::optional<CarStatus> status = GetCarStatus(licencePlate);
+		if (status != CarStatus::Serviced && status != CarStatus::PermanentlyUnavailable) {
+			Calendar.MarkStarted(booking);
+		}
+	}
+}
+
+std::optional<ContractRecord> Repository::FindContract(ContractId id) {
+	std::lock_guard lock(Mutex);
+	const ContractRecord* contract = Ledger.Find(id);
+	if (contract == nullptr) {
+		return std::nullopt;
+	}
+	return *contract;
+}
+
+ContractId Repository::GetLastContractId() {
+	std::lock_guard lock(Mutex);
+	return static_cast<ContractId>(Ledger.GetSize());
+}
+
+std::vector<ContractId> Repository::FindCustomerContracts(const std::string& phoneOrEmail) {
+	std::lock_guard lock(Mutex);
+	std::optional<Customer> customer = FindCustomer(phoneOrEmail);
+	auto it = ContractsByCustomer.find(GetContractCustomerKey(customer ? customer->GetPhone() : phoneOrEmail));
+	if (it == ContractsByCustomer.end()) {
+		return {};
+	}
+	return it->second;
+}
+
+std::vector<ContractId> Repository::FindCarContracts(const std::string& licencePlate) {
+	std::lock_guard lock(Mutex);
+	auto it = ContractsByPlate.find(licencePlate);
+	if (it == ContractsByPlate.end()) {
+		return {};
+	}
+	return it->second;
+}
+
+std::vector<ContractId> Repository::FindContractsDueBetween(std::chrono::system_clock::time_point from, std::chrono::system_clock::time_point to) {
+	std::lock_guard lock(Mutex);
+	std::vector<ContractId> result;
+	for (auto it = ContractsByDue.lower_bound(from); it != ContractsByDue.end() && it->first < to; ++it) {
+		result.push_back(it->second);
+	}
+	return result;
+}
+
+StorageVector Repository::GetContracts(const std::vector<ContractId>& ids) {
+	std::lock_guard lock(Mutex);
+	StorageVector result = { { "ID", "CUSTOMER", "LICENCE_PLATE", "START_DATE", "DUE_DATE", "PRICE", "STATE" } };
+	result.reserve(ids.size() + 1);
+	for (ContractId id : ids) {
+		const ContractRecord* contract = Ledger.Find(id);
+		if (contract != nullptr) {
+			result.push_back({ std::to_string(id), DescribeContractCustomer(*contract), std::string(contract->GetLicencePlate()),
+				ContractLedger::FormatTime(contract->GetStart(), "%d. %m. %Y %H:%M"), ContractLedger::FormatTime(contract->GetDue(), "%d. %m. %Y %H:%M"), std::to_string(contract->Price),
+				contract->GetState() == ContractState::Active ? "Active" : "Archived" });
+		}
+	}
+	return result;
+}
+
+ContentPage Repository::GetArchivedContracts(size_t page) {
+	std::lock_guard lock(Mutex);
+	ContentPage result = StartPage({ "ID", "CUSTOMER", "LICENCE_PLATE", "DUE_DATE", "PRICE" }, page, Archive.GetCount());
+	for (const auto& entry : Archive.GetPage(result.Page, LISTINGPAGESIZE)) {
+		result.Rows.push_back({ std::to_string(entry.Id), DescribeContractCustomer(entry.Contract), std::string(entry.Contract.GetLicencePlate()),
+			ContractLedger::FormatTime(entry.Contract.GetDue(), "%d. %m. %Y %H:%M"), std::to_string(entry.Contract.Price) });
+	}
+	return result;
+}
+
+ContentPage Repository::GetActiveContracts(size_t page) {
+	std::lock_guard lock(Mutex);
+	ContentPage result = StartPage({ "ID", "CUSTOMER", "LICENCE_PLATE", "START_DATE", "DUE_DATE", "PRICE" }, page, ActiveContracts.GetCount());
+	for (ContractId id : ActiveContracts.GetIds(result.Page * LISTINGPAGESIZE, LISTINGPAGESIZE)) {
+		const ContractRecord* contract = Ledger.Find(id);
+		result.Rows.push_back({ std::to_string(id), DescribeContractCustomer(*contract), std::string(contract->GetLicencePlate()),
+			ContractLedger::FormatTime(contract->GetStart(), "%d. %m. %Y %H:%M"), ContractLedger::FormatTime(contract->GetDue(), "%d. %m. %Y %H:%M"), std::to_string(contract->Price) });
+	}
+	return result;
+}
+
+StorageVector Repository::GetContracts(ContractState state) {
+	std::lock_guard lock(Mutex);
+	StorageVector result = { { "ID", "CUSTOMER", "LICENCE_PLATE", "START_DATE", "DUE_DATE", "PRICE" } };
+	for (ContractId id = 1; id <= Ledger.GetSize(); ++id) {
+		const ContractRecord* contract = Ledger.Find(id);
+		if (contract->GetState() == state) {
+			result.push_back({ std::to_string(id), DescribeContractCustomer(*contract), std::string(contract->GetLicencePlate()),
+				ContractLedger::FormatTime(contract->GetStart(), "%d. %m. %Y %H:%M"), ContractLedger::FormatTime(contract->GetDue(), "%d. %m. %Y %H:%M"), std::to_string(contract->Price) });
+		}
+	}
+	return result;
+}
+
+std::vector<std::string> Repository::RenderContract(ContractId id) {
+	std::lock_guard lock(Mutex);
+	const ContractRecord* contract = Ledger.Find(id);
+	if (contract == nullptr) {
+		return {};
+	}
+	if (contract->GetState() == ContractState::Archived) {
+		if (std::optional<std::string> text = Archive.ReadContract(id, contract->GetDue())) {
+			std::vector<std::string> lines;
+			std::istringstream stream(*text);
+			for (std::string line; std::getline(stream, line);) {
+				lines.push_back(line);
+			}
+			return lines;
+		}
+	}
+	return RenderContract(*contract);
+}
+
+std::vector<std::string> Repository::RenderContract(const ContractRecord& contract) {
+	std::string licencePlate(contract.GetLicencePlate());
+	std::string carLine = "Car: ";
+	size_t shard = GetShard(licencePlate);
+	std::shared_lock lock(ShardMutexes[shard]);
+	auto it = PlateIndex[shard].find(licencePlate);
+	if (it != PlateIndex[shard].end()) {
+		carLine += Cars[it->second].GetMake() + " " + Cars[it->second].GetModel() + ", ";
+	}
+	lock.unlock();
+	carLine += "License Plate: " + licencePlate;
+
+	return {
+		"Contract Details:",
+		"Customer: " + DescribeContractCustomer(contract),
+		carLine,
+		"Due Date: " + ContractLedger::FormatTime(contract.GetDue(), "%d. %m. %Y"),
+		"Due Hours: " + ContractLedger::FormatTime(contract.GetDue(), "%H:%M"),
+		"Hours of rent: " + std::to_string(contract.Hours),
+		"Total price: " + std::to_string(contract.Price) + "Kc",
+		"",
+		"Signed on: " + ContractLedger::FormatTime(contract.GetStart(), "%d. %m. %Y"),
+		"",
+		"Customers signutare:.......",
+		"Representative signutare:......."
+	};
+}
+
+std::string Repository::DescribeContractCustomer(const ContractRecord& contract) {
+	std::string key(contract.GetCustomer());
+	std::optional<Customer> customer = FindCustomer(key);
+	if (!customer) {
+		return key; // For example a contract imported from a file, which only knows the surname
+	}
+	return customer->GetName() + " " + customer->GetSurname();
+}
+
+int Repository::GetDelayedContractsCount() {
+	std::lock_guard lock(Mutex);
+	ActiveContracts.Refresh(std::chrono::system_clock::now());
+	return static_cast<int>(ActiveContracts.GetOverdueCount());
+}
+
+std::vector<DueContract> Repository::GetContractsDueNext(size_t count) {
+	std::lock_guard lock(Mutex);
+	ActiveContracts.Refresh(std::chrono::system_clock::now());
+	return ActiveContracts.GetNextDue(count);
+}
+
+std::shared_ptr<const ReadView> Repository::GetReadView() {
+	std::lock_guard lock(ViewMutex);
+	if (!LatestView || (ViewChanged && OpenViewChanges == 0)) {
+		auto view = std::make_shared<ReadView>(ViewHead); // Copies only the pointers to the chunks
+		view->Taken = std::chrono::system_clock::now();
+		LatestView = std::move(view);
+		ViewChanged = false;
+	}
+	return LatestView;
+}
+
+void Repository::ChangeReadView(const std::function<void(ReadView&)>& change) {
+	std::lock_guard lock(ViewMutex);
+	if (ViewLoading) {
+		return;
+	}
+	// Outside of a scope the readers keep their views and the repository does not need it anymore, so the chunks are changed in place
+	if (OpenViewChanges == 0) {
+		LatestView.reset();
+	}
+	change(ViewHead);
+	ViewChanged = true;
+}
+
+Repository::ViewChangeScope::ViewChangeScope() {
+	std::lock_guard lock(ViewMutex);
+	// The readers get this view until the last scope is closed, it is taken before the first change of the scope
+	if (OpenViewChanges++ == 0 && !LatestView) {
+		auto view = std::make_shared<ReadView>(ViewHead);
+		view->Taken = std::chrono::system_clock::now();
+		LatestView = std::move(view);
+		ViewChanged = false;
+	}
+}
+
+Repository::ViewChangeScope::~ViewChangeScope() {
+	std::lock_guard lock(ViewMutex);
+	--OpenViewChanges;
+}
+
+void Repository::BuildReadView() {
+	auto shardLocks = LockAllShards();
+	std::lock_guard lock(ViewMutex);
+	LatestView.reset();
+	ViewLoading = false;
+	ViewChanged = false;
+	ViewHead = ReadView();
+	for (size_t i = 0; i < Cars.size(); ++i) {
+		ViewHead.Cars.push_back(Cars[i]);
+		ViewHead.CarStatuses.push_back(CarStatuses[i]);
+	}
+	for (const auto& customer : Customers) {
+		ViewHead.Customers.push_back(customer);
+	}
+	for (ContractId id = 1; id <= Ledger.GetSize(); ++id) {
+		ViewHead.Contracts.push_back(*Ledger.Find(id));
+	}
+}
+
+size_t Repository::GetShard(std::string_view licencePlate) {
+	return std::hash<std::string_view>{}(licencePlate) % FLEETSHARDS;
+}
+
+std::array<std::unique_lock<std::shared_mutex>, FLEETSHARDS> Repository::LockAllShards() {
+	std::array<std::unique_lock<std::shared_mutex>, FLEETSHARDS> locks;
+	for (size_t i = 0; i < FLEETSHARDS; ++i) {
+		locks[i] = std::unique_lock(ShardMutexes[i]);
+	}
+	return locks;
+}
+
+size_t Repository::FindCarPosition(CarStatus status, const std::string& licencePlate) {
+	size_t shard = GetShard(licencePlate);
+	auto it = PlateIndex[shard].find(licencePlate);
+	if (it == PlateIndex[shard].end() || CarStatuses[it->second] != status) {
+		return Cars.size();
+	}
+	return it->second;
+}
+
+void Repository::IndexCustomer(size_t position) {
+	const Customer& customer = Customers[position];
+	std::string phone = NormalizePhone(customer.GetPhone());
+	if (!phone.empty()) {
+		PhoneIndex.emplace(phone, position);
+	}
+	std::string email = NormalizeEmail(customer.GetEmailAdress());
+	if (!email.empty()) {
+		EmailIndex.emplace(email, position);
+	}
+}
+
+std::string Repository::NormalizePhone(const std::string& phone) {
+	std::string result;
+	for (char c : phone) {
+		if (std::isdigit(static_cast<unsigned char>(c))) {
+			result.push_back(c);
+		}
+		else if (c == '+' && result.empty()) {
+			result.push_back(c);
+		}
+		else if (c != ' ' && c != '-' && c != '.' && c != '(' && c != ')') {
+			return ""; // Not a phone number
+		}
+	}
+	if (result.rfind("00", 0) == 0) {
+		result.replace(0, 2, "+");
+	}
+	return result;
+}
+
+std::string Repository::NormalizeEmail(const std::string& email) {
+	size_t first = email.find_first_not_of(" \t\r");
+	if (first == std::string::npos) {
+		return "";
+	}
+	size_t last = email.find_last_not_of(" \t\r");
+	std::string result = email.substr(first, last - first + 1);
+	std::transform(result.begin(), result.end(), result.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+	return result;
+}
@@ -0,0 +1,477 @@
+#pragma once
+
+#ifndef _REPOSITORY_H_
+#define _REPOSITORY_H_
+
+#include <optional>
+#include <array>
+#include <unordered_map>
+#include <map>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <shared_mutex>
+#include "FleetView.h"
+#include "Schema.h"
+#include "ContractTracker.h"
+#include "ArchiveStore.h"
+#include "ReservationCalendar.h"
+#include "ReadView.h"
+
+/**
+ * @brief The number of the shards of the cars, every shard has its own lock.
+ */
+constexpr size_t FLEETSHARDS = 16;
+
+/**
+ * @brief The number of contracts listed as due next.
+ */
+constexpr size_t NEXTDUECONTRACTS = 5;
+
+/**
+ * @brief The number of records listed on one page.
+ */
+constexpr size_t LISTINGPAGESIZE = 20;
+
+/**
+ * @brief Shown for a car record that does not fit the car, it is left in the file but not loaded.
+ */
+constexpr char UNLOADEDCARMESSAGE[] = "A car was not loaded, check the numbers and the length of the licence plate:";
+
+/**
+ * @brief One page of a listing of records.
+ */
+struct ContentPage {
+    StorageVector Rows; // The header first, then the records of the page
+    std::vector<size_t> ColumnWidths; // The widths of the columns of the whole listing, empty if the columns fit just the page
+    size_t Page = 0; // The number of the page, the first page is 0
+    size_t PageCount = 1;
+};
+
+/**
+ * @brief The in-memory repository of all the cars, customers and users.
+ * The files are parsed only once (by Load), every read is then served from memory
+ * and every change is written through to the files by the FileWriter.
+ * Every public function locks what it uses, so the repository can be shared by the sessions of the server:
+ * - The cars are split into FLEETSHARDS shards by the hash of their licence plates. A reader-writer lock of a shard guards the plate index
+ *   and the statuses of its cars, so finding cars runs in parallel and only the moves of the cars of the same shard wait for each other.
+ * - The listings of the cars (StatusPositions, Fleet) have their own reader-writer lock, a move updates them while it holds its shard,
+ *   so a listing never shows a car in two statuses or in none. Adding a car (or loading) locks all the shards and the listings.
+ * - The customers, users and contracts are guarded by one recursive lock.
+ * - The long reports read a ReadView (see GetReadView) instead, which does not hold any of the locks.
+ * The locks are taken in this order: the recursive lock, the shards (ascending), the listings, the read views.
+ */
+class Repository {
+public:
+    /**
+     * @brief Loads all the cars, customers and users from the files. Any previously loaded data is discarded.
+     * A binary snapshot is used instead of the text files when it is newer than them, otherwise it is regenerated.
+     */
+    static void Load();
+
+    /**
+     * @brief Turns the use of the binary snapshots on or off. The snapshots are used by default.
+     * @param enabled True to use (and regenerate) the snapshots, false to always parse the text files.
+     */
+    static void SetSnapshots(bool enabled);
+
+    /**
+     * @brief Get info about all the cars with the given status. The first row is the header of the file.
+     * @param status the status of the cars you want to get
+     * @return A StorageVector containing the properties of all the cars.
+     */
+    static StorageVector GetCars(CarStatus status);
+
+    /**
+     * @brief Get info about all the cars that meet the conditions of the query in the order of the query. The first row is the header of the files.
+     * @param query The conditions the cars have to meet and their order.
+     * @return A StorageVector containing the properties of the selected cars.
+     */
+    static StorageVector SelectCars(const FleetQuery& query);
+
+    /**
+     * @brief Get one page of the cars with the given status. Only the cars of the page are converted to rows
+     * and the widths of the columns are kept up to date as the cars are added.
+     * @param status The status of the listed cars.
+     * @param page The number of the page, the last page is returned if there are fewer pages.
+     * @return The page of the listing.
+     */
+    static ContentPage GetCarsPage(CarStatus status, size_t page);
+
+    /**
+     * @brief Get one page of the customers. Only the customers of the page are converted to rows
+     * and the widths of the columns are kept up to date as the customers are added.
+     * @param page The number of the page, the last page is returned if there are fewer pages.
+     * @return The page of the listing.
+     */
+    static ContentPage GetCustomersPage(size_t page);
+
+    /**
+     * @brief Get one page of a listing that is already in memory, the widths of the columns fit the page.
+     * @param content The listing, the first row is the header.
+     * @param page The number of the page, the last page is returned if there are fewer pages.
+     * @return The page of the listing.
+     */
+    static ContentPage Paginate(const StorageVector& content, size_t page);
+
+    /**
+     * @brief Get info about all the customers. The first row is the header of the file.
+     * @return A StorageVector containing the properties of all customers.
+     */
+    static StorageVector GetCustomers();
+
+    /**
+     * @brief Finds a car with the given licence plate among the cars with the given status.
+     * @param status The status of the searched car.
+     * @param licencePlate The licence plate of the searched car.
+     * @return The car or std::nullopt if there is no such car.
+     */
+    static std::optional<Car> FindCar(CarStatus status, const std::string& licencePlate);
+
+    /**
+     * @brief Finds out the status of the car with the given licence plate (i.e. which file the car is in).
+     * @param licencePlate The licence plate of the car.
+     * @return The status of the car or std::nullopt if there is no such car.
+     */
+    static std::optional<CarStatus> GetCarStatus(const std::string& licencePlate);
+
+    /**
+     * @brief Finds a customer with the given phone number or e-mail address.
+     * @param phoneOrEmail The phone number or the e-mail address of the searched customer.
+     * @return The customer or std::nullopt if there is no such customer.
+     */
+    static std::optional<Customer> FindCustomer(const std::string& phoneOrEmail);
+
+    /**
+     * @brief Finds a user with the given username.
+     * @param username The username of the searched user.
+     * @return The user or std::nullopt if there is no such user.
+     */
+    static std::optional<User> FindUser(const std::string& username);
+
+    /**
+     * @brief Adds a car with the given status to the repository and to its file.
+     * @param car The car to add.
+     * @param status The status of the added car.
+     * @return False if there already is a car with the same licence plate, the car is not added then.
+     */
+    static bool AddCar(const Car& car, CarStatus status);
+
+    /**
+     * @brief Adds a customer to the repository and to the customer list.
+     * @param customer The customer to add.
+     * @return False if there already is a customer with the same phone number or e-mail, the customer is not added then.
+     */
+    static bool AddCustomer(const Customer& customer);
+
+    /**
+     * @brief Adds a user to the repository and to the user list.
+     * @param user The user to add.
+     */
+    static void AddUser(const User& user);
+
+    /**
+     * @brief Moves a car from one status to another both in the repository and in the files.
+     * @param licencePlate The licence plate of the moved car.
+     * @param from The current status of the car.
+     * @param to The new status of the car.
+     * @return True if the car was found and moved, false otherwise.
+     */
+    static bool MoveCar(const std::string& licencePlate, CarStatus from, CarStatus to);
+
+    /**
+     * @brief Appends a new active contract to the ledger, books the car for the period of the contract and starts tracking its due date.
+     * A contract starting in the future is a reservation, the car is rented out when the reservation starts (see UpdateCarStatuses).
+     * The price is the cost per hour of the car times the whole hours from the start to the due date.
+     * @param customer The customer renting the car.
+     * @param car The rented car.
+     * @param start The start of the contract.
+     * @param dueDate The due date of the contract.
+     * @return The identifier of the contract, 0 if the due date is not after the start, the hours or the price do not fit the record,
+     * the car is booked in the period or the contract could not be written.
+     */
+    static ContractId CreateContract(const Customer& customer, const Car& car, const std::chrono::system_clock::time_point& start, const std::chrono::system_clock::time_point& dueDate);
+
+    /**
+     * @brief Archives an active contract, frees the rest of its period in the calendar and stops tracking its due date.
+     * If the contract had started, its car is returned to the available cars (unless another contract of the car is running).
+     * @param id The identifier of the contract.
+     * @return False if there is no such active contract or the ledger could not be written.
+     */
+    static bool ArchiveContract(ContractId id);
+
+    /**
+     * @brief Finds out if a car is not booked by any active contract in the whole period.
+     * @param licencePlate The licence plate of the car.
+     * @param from The beginning of the period (inclusive).
+     * @param to The end of the period (exclusive).
+     * @return True if the car can be booked for the period.
+     */
+    static bool IsCarFree(const std::string& licencePlate, std::chrono::system_clock::time_point from, std::chrono::system_clock::time_point to);
+
+    /**
+     * @brief Get info about the available and rented cars that are not booked in any part of the period. The first row is the header of the files.
+     * @param from The beginning of the period (inclusive).
+     * @param to The end of the period (exclusive).
+     * @return A StorageVector containing the properties of the free cars.
+     */
+    static StorageVector FindFreeCars(std::chrono::system_clock::time_point from, std::chrono::system_clock::time_point to);
+
+    /**
+     * @brief Derives the statuses of the cars from the calendar: the available cars whose reservations have started are moved to the rented cars.
+     * Only the started reservations whose car has not been rented for them yet are checked, a reservation whose car
+     * is not available (for example still in the repair shop) is checked again by the next call.
+     */
+    static void UpdateCarStatuses();
+
+    /**
+     * @brief Finds a contract.
+     * @param id The identifier of the contract.
+     * @return The contract or std::nullopt if there is no such contract.
+     */
+    static std::optional<ContractRecord> FindContract(ContractId id);
+
+    /**
+     * @brief Retrieves the identifier of the newest contract, 0 if there are no contracts.
+     */
+    static ContractId GetLastContractId();
+
+    /**
+     * @brief Finds all the contracts (active and archived) of a customer, the rental history of the customer.
+     * @param phoneOrEmail The phone number or the e-mail address of the customer (or the surname for the imported contracts).
+     * @return The identifiers of the contracts, the oldest first.
+     */
+    static std::vector<ContractId> FindCustomerContracts(const std::string& phoneOrEmail);
+
+    /**
+     * @brief Finds all the contracts (active and archived) of a car.
+     * @param licencePlate The licence plate of the car.
+     * @return The identifiers of the contracts, the oldest first.
+     */
+    static std::vector<ContractId> FindCarContracts(const std::string& licencePlate);
+
+    /**
+     * @brief Finds all the contracts (active and archived) due in the given period.
+     * @param from The beginning of the period (inclusive).
+     * @param to The end of the period (exclusive).
+     * @return The identifiers of the contracts ordered by their due dates.
+     */
+    static std::vector<ContractId> FindContractsDueBetween(std::chrono::system_clock::time_point from, std::chrono::system_clock::time_point to);
+
+    /**
+     * @brief Get info about the given contracts. The first row is the header.
+     * @param ids The identifiers of the contracts.
+     * @return A StorageVector containing the identifier, customer, licence plate, due date, price and state of the contracts.
+     */
+    static StorageVector GetContracts(const std::vector<ContractId>& ids);
+
+    /**
+     * @brief Get info about one page of the archived contracts, the latest first.
+     * Only the index entries of the page are read from the archive.
+     * @param page The number of the page, the last page is returned if there are fewer pages.
+     * @return The page with the identifier, customer, licence plate, due date and price of the contracts.
+     */
+    static ContentPage GetArchivedContracts(size_t page);
+
+    /**
+     * @brief Get info about one page of the active contracts in the order of their identifiers.
+     * The page is taken from the tracked active contracts, the archived ones are not visited.
+     * @param page The number of the page, the last page is returned if there are fewer pages.
+     * @return The page with the identifier, customer, licence plate, start date, due date and price of the contracts.
+     */
+    static ContentPage GetActiveContracts(size_t page);
+
+    /**
+     * @brief Get info about all the contracts with the given state. The first row is the header.
+     * @param state The state of the contracts.
+     * @return A StorageVector containing the identifier, customer, licence plate, due date and price of the contracts.
+     */
+    static StorageVector GetContracts(ContractState state);
+
+    /**
+     * @brief Renders the human-readable text of a contract. An archived contract is read from the archive as it was when it was archived.
+     * @param id The identifier of the contract.
+     * @return The lines of the contract, empty if there is no such contract.
+     */
+    static std::vector<std::string> RenderContract(ContractId id);
+
+    /**
+     * @brief Retrieves the number of active contracts that are past their due date right now.
+     * @return The number of delayed contracts.
+     */
+    static int GetDelayedContractsCount();
+
+    /**
+     * @brief Retrieves the active contracts that are due next (and not delayed yet), the soonest first.
+     * @param count The maximum number of returned contracts.
+     * @return The contracts with their due dates.
+     */
+    static std::vector<DueContract> GetContractsDueNext(size_t count);
+
+    /**
+     * @brief Takes a consistent view of the cars, customers and contracts as they are now, for example for a long report.
+     * The view is read without any lock and never stalls the changes of the repository, which copy only the chunks the views still use.
+     * The view is shared by all the readers until the next change. While an operation that changes several things
+     * (for example a new contract and the move of its car) is in progress, the view from before it is returned.
+     * @return The view, it is freed when the last reader drops it.
+     */
+    static std::shared_ptr<const ReadView> GetReadView();
+
+    /**
+     * @brief Normalizes a phone number so that different ways of writing it match.
+     * Spaces, dashes, dots and brackets are removed and the 00 prefix of a country code is replaced by +.
+     * @param phone The phone number to normalize.
+     * @return The normalized phone number.
+     */
+    static std::string NormalizePhone(const std::string& phone);
+
+    /**
+     * @brief Converts the customer key of a contract to the key of the customer index (the normalized phone number).
+     * The imported contracts store the surname of the customer instead, which is returned as it is.
+     */
+    static std::string GetContractCustomerKey(std::string_view customer);
+
+    /**
+     * @brief Normalizes an e-mail address (trims it and converts it to lower case).
+     * @param email The e-mail address to normalize.
+     * @return The normalized e-mail address.
+     */
+    static std::string NormalizeEmail(const std::string& email);
+
+private:
+    /**
+     * @brief Loads all the cars (from the snapshot or the text files) and builds the licence plate index.
+     */
+    static void LoadCars();
+
+    /**
+     * @brief Loads all the customers (from the snapshot or the text file) and builds the customer indexes.
+     */
+    static void LoadCustomers();
+
+    /**
+     * @brief Loads all the users (from the snapshot or the text file).
+     */
+    static void LoadUsers();
+
+    /**
+     * @brief Opens the contracts ledger, tracks the due dates of all the active contracts and books their cars in the calendar.
+     */
+    static void LoadContracts();
+
+    /**
+     * @brief Appends the contracts written as separate text files (before the ledger existed) to the ledger.
+     */
+    static void ImportLegacyContracts();
+
+    /**
+     * @brief Rolls the archived contracts of the ledger into the archive. Used when the archive is new.
+     */
+    static void ArchiveLedgerContracts();
+
+    /**
+     * @brief Renders the text of a contract from its record in the ledger.
+     */
+    static std::vector<std::string> RenderContract(const ContractRecord& contract);
+
+    /**
+     * @brief Describes the customer of a contract by their name, or by the stored key if the customer is unknown.
+     */
+    static std::string DescribeContractCustomer(const ContractRecord& contract);
+
+    /**
+     * @brief Adds the contract to the customer, licence plate and due date indexes.
+     * @param id The identifier of the contract.
+     */
+    static void IndexContract(ContractId id);
+
+    /**
+     * @brief Starts a page of a listing with the given header and number of records.
+     * @return The page with the header and the clamped number of the page, its records start at Page * LISTINGPAGESIZE.
+     */
+    static ContentPage StartPage(const Properties& header, size_t page, size_t recordCount);
+
+    /**
+     * @brief Changes the head of the read views. The next view is taken from the changed head once no ViewChangeScope is open.
+     * The changes made while loading are left out, the head is built again at the end of Load.
+     * @param change Changes the head, it has to be called with the lock of the changed data.
+     */
+    static void ChangeReadView(const std::function<void(ReadView&)>& change);
+
+    /**
+     * @brief Holds the new read views back while it exists, so all the changes of an operation that changes several things
+     * are published in one view. The scopes can be nested and the scopes of different threads can overlap.
+     */
+    struct ViewChangeScope {
+        ViewChangeScope();
+        ~ViewChangeScope();
+
+        ViewChangeScope(const ViewChangeScope&) = delete;
+        ViewChangeScope& operator=(const ViewChangeScope&) = delete;
+    };
+
+    /**
+     * @brief Builds the head of the read views from all the loaded data. The recursive lock has to be held.
+     */
+    static void BuildReadView();
+
+    /**
+     * @brief Decides the shard of a car.
+     * @param licencePlate The licence plate of the car.
+     * @return The index of the shard in ShardMutexes and PlateIndex.
+     */
+    static size_t GetShard(std::string_view licencePlate);
+
+    /**
+     * @brief Locks all the shards exclusively (in ascending order), so the whole fleet can be changed.
+     */
+    static std::array<std::unique_lock<std::shared_mutex>, FLEETSHARDS> LockAllShards();
+
+    /**
+     * @brief Finds the position of the car in the fleet. The shard of the car has to be locked.
+     * @param status The status of the searched car.
+     * @param licencePlate The licence plate of the searched car.
+     * @return The position of the car or Cars.size() if there is no such car.
+     */
+    static size_t FindCarPosition(CarStatus status, const std::string& licencePlate);
+
+    /**
+     * @brief Adds the customer on the given position to the phone and e-mail indexes.
+     * @param position The position of the customer in Customers.
+     */
+    static void IndexCustomer(size_t position);
+
+    static std::vector<Car> Cars;
+    static std::vector<CarStatus> CarStatuses; // CarStatuses[i] is the status of Cars[i], guarded by the shard of the car
+    static std::array<std::unordered_map<std::string, size_t>, FLEETSHARDS> PlateIndex; // Licence plate -> position of the car in Cars, one map per shard
+    static std::array<std::shared_mutex, FLEETSHARDS> ShardMutexes;
+    static FleetView Fleet; // The numeric attributes and statuses of Cars in columns
+    static std::array<std::vector<size_t>, NUMBEROFCARSTATUSES> StatusPositions; // The positions of the cars with each status in Cars, ascending
+    static std::vector<size_t> CarColumnWidths; // The widths of the columns of the car listings
+    static std::shared_mutex ListingMutex; // Guards Fleet, StatusPositions and CarColumnWidths
+    static std::unique_ptr<std::pmr::monotonic_buffer_resource> LoadArena; // The strings of the loaded customers and users, released at once by the next Load
+    static std::vector<Customer> Customers;
+    static std::unordered_map<std::string, size_t> PhoneIndex; // Normalized phone -> position of the customer in Customers
+    static std::unordered_map<std::string, size_t> EmailIndex; // Normalized e-mail -> position of the customer in Customers
+    static std::vector<size_t> CustomerColumnWidths; // The widths of the columns of the customer listing
+    static std::vector<User> Users;
+    static ContractLedger Ledger;
+    static ContractTracker ActiveContracts; // The due dates of the active contracts in Ledger
+    static ArchiveStore Archive; // The texts of the archived contracts in Ledger
+    static ReservationCalendar Calendar; // The periods the cars are booked for by the active contracts in Ledger
+    static std::unordered_map<std::string, std::vector<ContractId>> ContractsByCustomer; // Customer key -> contracts of the customer
+    static std::unordered_map<std::string, std::vector<ContractId>> ContractsByPlate; // Licence plate -> contracts of the car
+    static std::multimap<std::chrono::system_clock::time_point, ContractId> ContractsByDue; // Due date -> contract
+    static Properties CarsHeader;
+    static Properties CustomersHeader;
+    static bool Snapshots;
+    static ReadView ViewHead; // The cars, customers and contracts the next view is taken from
+    static std::shared_ptr<const ReadView> LatestView; // The last view taken, nullptr if there is none
+    static bool ViewChanged; // ViewHead was changed since LatestView was taken
+    static bool ViewLoading; // ViewHead is left as it is until Load builds it again
+    static size_t OpenViewChanges; // The number of the open ViewChangeScope objects, no view is taken while there is one
+    static std::mutex ViewMutex; // Guards ViewHead, LatestView and the state of the changes, it is taken after all the other locks and only for a moment
+    static std::recursive_mutex Mutex; // Guards the customers, users and contracts, recursive because the public functions call each other
+};
+
+#endif // !_REPOSITORY_H_
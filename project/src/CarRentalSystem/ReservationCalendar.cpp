@@ -0,0 +1,62 @@
+#include "ReservationCalendar.h"
+
+bool ReservationCalendar::Add(const std::string& licencePlate, ContractId id, std::chrono::system_clock::time_point start, std::chrono::system_clock::time_point end) {
+	if (end <= start || FindCollision(licencePlate, start, end) != 0) {
+		return false;
+	}
+	Cars[licencePlate].emplace(start, Booking{ end, id });
+	Upcoming.emplace(start, id);
+	return true;
+}
+
+bool ReservationCalendar::Remove(const std::string& licencePlate, ContractId id, std::chrono::system_clock::time_point start) {
+	auto car = Cars.find(licencePlate);
+	if (car == Cars.end()) {
+		return false;
+	}
+	auto booking = car->second.find(start);
+	if (booking == car->second.end() || booking->second.Id != id) {
+		return false;
+	}
+	car->second.erase(booking);
+	if (car->second.empty()) {
+		Cars.erase(car);
+	}
+	Upcoming.erase(DueContract(start, id));
+	return true;
+}
+
+void ReservationCalendar::Clear() {
+	Cars.clear();
+	Upcoming.clear();
+}
+
+ContractId ReservationCalendar::FindCollision(const std::string& licencePlate, std::chrono::system_clock::time_point from, std::chrono::system_clock::time_point to) const {
+	auto car = Cars.find(licencePlate);
+	if (car == Cars.end()) {
+		return 0;
+	}
+	// The bookings do not overlap, so the last one starting before the period ends also ends last among them
+	auto booking = car->second.lower_bound(to);
+	if (booking == car->second.begin()) {
+		return 0;
+	}
+	--booking;
+	return booking->second.End > from ? booking->second.Id : 0;
+}
+
+bool ReservationCalendar::IsFree(const std::string& licencePlate, std::chrono::system_clock::time_point from, std::chrono::system_clock::time_point to) const {
+	return FindCollision(licencePlate, from, to) == 0;
+}
+
+std::vector<DueContract> ReservationCalendar::GetStarted(std::chrono::system_clock::time_point now) const {
+	std::vector<DueContract> started;
+	for (auto it = Upcoming.begin(); it != Upcoming.end() && it->first <= now; ++it) {
+		started.push_back(*it);
+	}
+	return started;
+}
+
+void ReservationCalendar::MarkStarted(const DueContract& booking) {
+	Upcoming.erase(booking);
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#ifndef _RESERVATIONCALENDAR_H_
+#define _RESERVATIONCALENDAR_H_
+
+#include <map>
+#include <set>
+#include <unordered_map>
+#include "ContractTracker.h"
+
+/**
+ * @brief The period a car is booked for by a contract (a rental or a reservation).
+ */
+struct Booking {
+    std::chrono::system_clock::time_point End; // Exclusive
+    ContractId Id;
+};
+
+/**
+ * @brief The availability calendar of the cars. Every car has its own interval index of its bookings.
+ * The bookings of a car never overlap, so the index is ordered by the start of the bookings and the ends are ordered as well,
+ * which is why the only booking that can collide with a period is the last one starting before the period ends.
+ * Finding out if a car is free in a period therefore takes logarithmic time in the number of its bookings.
+ */
+class ReservationCalendar {
+public:
+    /**
+     * @brief Books a car for a period, unless the car is already booked in any part of it.
+     * @param licencePlate The licence plate of the car.
+     * @param id The identifier of the contract.
+     * @param start The beginning of the period (inclusive).
+     * @param end The end of the period (exclusive).
+     * @return False if the period collides with another booking of the car or is empty.
+     */
+    bool Add(const std::string& licencePlate, ContractId id, std::chrono::system_clock::time_point start, std::chrono::system_clock::time_point end);
+
+    /**
+     * @brief Removes a booking (for example because its contract was archived).
+     * @param licencePlate The licence plate of the car.
+     * @param id The identifier of the contract.
+     * @param start The beginning of the booking.
+     * @return True if the car had the booking.
+     */
+    bool Remove(const std::string& licencePlate, ContractId id, std::chrono::system_clock::time_point start);
+
+    /**
+     * @brief Removes all the bookings.
+     */
+    void Clear();
+
+    /**
+     * @brief Finds the booking of a car that collides with a period.
+     * @param licencePlate The licence plate of the car.
+     * @param from The beginning of the period (inclusive).
+     * @param to The end of the period (exclusive).
+     * @return The identifier of the colliding contract, 0 if the car is free in the whole period.
+     */
+    ContractId FindCollision(const std::string& licencePlate, std::chrono::system_clock::time_point from, std::chrono::system_clock::time_point to) const;
+
+    /**
+     * @brief Finds out if a car is free in the whole period.
+     */
+    bool IsFree(const std::string& licencePlate, std::chrono::system_clock::time_point from, std::chrono::system_clock::time_point to) const;
+
+    /**
+     * @brief Retrieves the bookings that have started and were not marked as started yet, the earliest first.
+     * A booking is returned by every call until it is marked, so one whose car could not be rented yet is retried.
+     * @param now The current time.
+     * @return The started bookings with their start times.
+     */
+    std::vector<DueContract> GetStarted(std::chrono::system_clock::time_point now) const;
+
+    /**
+     * @brief Marks a started booking as handled, it is not returned by GetStarted anymore.
+     * @param booking The booking with its start time.
+     */
+    void MarkStarted(const DueContract& booking);
+
+private:
+    std::unordered_map<std::string, std::map<std::chrono::system_clock::time_point, Booking>> Cars; // Licence plate -> start -> booking
+    std::set<DueContract> Upcoming; // The bookings that were not marked as started, ordered by their start
+};
+
+#endif // !_RESERVATIONCALENDAR_H_
@@ -0,0 +1,341 @@
+#pragma once
+
+#ifndef _SCHEMA_H_
+#define _SCHEMA_H_
+
+#include <array>
+#include <charconv>
+#include <limits>
+#include <optional>
+#include "FileHandler.h"
+
+constexpr char INVALIDPROPERTYMESSAGE[] = "Invalid property";
+
+/**
+ * @brief The kind of value stored in a field of a record.
+ */
+enum class FieldType { Text, Number, Flag };
+
+/**
+ * @brief Describes one field (column) of the records of an entity: its name, how it is validated and which getter reads it.
+ * Only the getter of the field's type is set.
+ */
+template <typename Entity>
+struct FieldDescriptor {
+    std::string_view Name;
+    FieldType Type;
+    std::string (Entity::* GetText)() const = nullptr;
+    int (Entity::* GetNumber)() const = nullptr;
+    bool (Entity::* GetFlag)() const = nullptr;
+    int Min = 0;
+    int Max = 0;
+    size_t MaxLength = 0; // 0 means any length
+};
+
+/**
+ * @brief Describes a text field.
+ * @param name The name of the field.
+ * @param getter The getter of the field.
+ * @param maxLength The longest accepted value, 0 means any length.
+ */
+template <typename Entity>
+constexpr FieldDescriptor<Entity> TextField(std::string_view name, std::string (Entity::* getter)() const, size_t maxLength = 0) {
+    return { .Name = name, .Type = FieldType::Text, .GetText = getter, .MaxLength = maxLength };
+}
+
+/**
+ * @brief Describes a number field, the accepted range is the range of the type the entity stores the number in.
+ * @param name The name of the field.
+ * @param getter The getter of the field.
+ */
+template <typename Entity, typename Storage>
+constexpr FieldDescriptor<Entity> NumberField(std::string_view name, int (Entity::* getter)() const) {
+    static_assert(sizeof(Storage) < sizeof(int), "The stored number has to be narrower than int");
+    return { .Name = name, .Type = FieldType::Number, .GetNumber = getter,
+        .Min = std::numeric_limits<Storage>::min(), .Max = std::numeric_limits<Storage>::max() };
+}
+
+/**
+ * @brief Describes a flag field stored as 1 or 0.
+ * @param name The name of the field.
+ * @param getter The getter of the field.
+ */
+template <typename Entity>
+constexpr FieldDescriptor<Entity> FlagField(std::string_view name, bool (Entity::* getter)() const) {
+    return { .Name = name, .Type = FieldType::Flag, .GetFlag = getter };
+}
+
+/**
+ * @brief A parsed field of a record. Text always views the original property.
+ */
+struct FieldValue {
+    std::string_view Text;
+    int Number = 0;
+    bool Flag = false;
+};
+
+template <size_t Count>
+using FieldValues = std::array<FieldValue, Count>;
+
+/**
+ * @brief The fields of the records of an entity in the order they are stored in the files.
+ * Every specialization has the Fields array and constructs the entity from the parsed fields.
+ */
+template <typename Entity>
+struct Schema;
+
+template <>
+struct Schema<Car> {
+    static constexpr std::array Fields = {
+        TextField<Car>("MAKE", &Car::GetMake),
+        TextField<Car>("MODEL", &Car::GetModel),
+        NumberField<Car, Car::YearType>("YEAR", &Car::GetYear),
+        TextField<Car>("COLOR", &Car::GetColor),
+        TextField<Car>("LICENCE_PLATE", &Car::GetLicencePlate, MAXLICENCEPLATELENGTH),
+        TextField<Car>("MOTORIZATION", &Car::GetMotorization),
+        TextField<Car>("GEARBOX", &Car::GetGearbox),
+        NumberField<Car, Car::SeatsType>("SEATS", &Car::GetSeats),
+        NumberField<Car, Car::CostPerHourType>("COST_PER_HOUR", &Car::GetCostPerHour)
+    };
+    static constexpr size_t FieldCount = Fields.size();
+
+    static Car Construct(const FieldValues<FieldCount>& values, std::pmr::memory_resource*) {
+        return Car(std::get<0>(values).Text, std::get<1>(values).Text, std::get<2>(values).Number, std::get<3>(values).Text, std::get<4>(values).Text,
+            std::get<5>(values).Text, std::get<6>(values).Text, std::get<7>(values).Number, std::get<8>(values).Number);
+    }
+};
+
+template <>
+struct Schema<Customer> {
+    static constexpr std::array Fields = {
+        TextField<Customer>("NAME", &Customer::GetName),
+        TextField<Customer>("SURNAME", &Customer::GetSurname),
+        TextField<Customer>("EMAIL", &Customer::GetEmailAdress),
+        TextField<Customer>("PHONE", &Customer::GetPhone),
+        TextField<Customer>("ADRESS", &Customer::GetAdress)
+    };
+    static constexpr size_t FieldCount = Fields.size();
+
+    static Customer Construct(const FieldValues<FieldCount>& values, std::pmr::memory_resource* resource) {
+        return Customer(std::get<0>(values).Text, std::get<1>(values).Text, std::get<2>(values).Text, std::get<3>(values).Text,
+            std::get<4>(values).Text, resource);
+    }
+};
+
+template <>
+struct Schema<User> {
+    static constexpr std::array Fields = {
+        TextField<User>("USERNAME", &User::GetUsername),
+        TextField<User>("PASSWORD", &User::GetPassword),
+        FlagField<User>("ADMIN_STATUS", &User::GetAdminStatus)
+    };
+    static constexpr size_t FieldCount = Fields.size();
+
+    static User Construct(const FieldValues<FieldCount>& values, std::pmr::memory_resource* resource) {
+        return User(std::get<0>(values).Text, std::get<1>(values).Text, std::get<2>(values).Flag, resource);
+    }
+};
+
+/**
+ * @brief Checks that every field has a name usable in prompts and files and the getter of its type.
+ */
+template <typename Entity>
+constexpr bool IsValidSchema() {
+    for (const auto& field : Schema<Entity>::Fields) {
+        if (field.Name.empty() || field.Name.find(' ') != std::string_view::npos || field.Name.find(DELIMITER) != std::string_view::npos) {
+            return false;
+        }
+        bool hasGetter = (field.Type == FieldType::Text && field.GetText != nullptr)
+            || (field.Type == FieldType::Number && field.GetNumber != nullptr && field.Min <= field.Max)
+            || (field.Type == FieldType::Flag && field.GetFlag != nullptr);
+        if (!hasGetter) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Finds the position of the field with the given name.
+ * @return The position, or the number of fields if there is no such field.
+ */
+template <typename Entity>
+constexpr size_t FieldPosition(std::string_view name) {
+    for (size_t i = 0; i < Schema<Entity>::FieldCount; ++i) {
+        if (Schema<Entity>::Fields[i].Name == name) {
+            return i;
+        }
+    }
+    return Schema<Entity>::FieldCount;
+}
+
+static_assert(IsValidSchema<Car>() && IsValidSchema<Customer>() && IsValidSchema<User>(), "Invalid field descriptor");
+static_assert(FieldPosition<Car>("LICENCE_PLATE") == LICENCEPLATEPOSITION, "The licence plate has to be on LICENCEPLATEPOSITION");
+
+/**
+ * @brief The size of the column list of an entity including the terminating null character.
+ */
+template <typename Entity>
+constexpr size_t ColumnNamesSize() {
+    size_t size = 0;
+    for (const auto& field : Schema<Entity>::Fields) {
+        size += field.Name.size() + 1; // The name and the following space (the null character after the last name)
+    }
+    return size;
+}
+
+/**
+ * @brief Creates the null-terminated list of the field names of an entity separated by spaces, for example to prompt the user.
+ */
+template <typename Entity>
+constexpr std::array<char, ColumnNamesSize<Entity>()> ColumnNames() {
+    std::array<char, ColumnNamesSize<Entity>()> names = {};
+    size_t position = 0;
+    for (const auto& field : Schema<Entity>::Fields) {
+        if (position != 0) {
+            names[position++] = ' ';
+        }
+        for (char c : field.Name) {
+            names[position++] = c;
+        }
+    }
+    names[position] = '\0';
+    return names;
+}
+
+/**
+ * @brief Parses and validates the properties of a record without throwing.
+ * @param props Views of the properties.
+ * @return The parsed fields, or nothing if the number of properties is wrong or a property is invalid.
+ */
+template <typename Entity>
+std::optional<FieldValues<Schema<Entity>::FieldCount>> ParseFields(PropertyViews props) {
+    if (props.size() != Schema<Entity>::FieldCount) {
+        return std::nullopt;
+    }
+    FieldValues<Schema<Entity>::FieldCount> values;
+    for (size_t i = 0; i < Schema<Entity>::FieldCount; ++i) {
+        const auto& field = Schema<Entity>::Fields[i];
+        values[i].Text = props[i];
+        switch (field.Type) {
+        case FieldType::Text:
+            if (field.MaxLength != 0 && props[i].size() > field.MaxLength) {
+                return std::nullopt;
+            }
+            break;
+        case FieldType::Number:
+            if (!TryParseNumber(props[i], values[i].Number) || values[i].Number < field.Min || values[i].Number > field.Max) {
+                return std::nullopt;
+            }
+            break;
+        case FieldType::Flag:
+            values[i].Flag = props[i] == "1";
+            break;
+        }
+    }
+    return values;
+}
+
+/**
+ * @brief Parses a record into an entity without throwing on invalid properties.
+ * @param props Views of the properties.
+ * @param resource The memory resource the strings of the entity are allocated from (not used by cars).
+ * @return The entity, or nothing if the properties are invalid.
+ */
+template <typename Entity>
+std::optional<Entity> ParseRecord(PropertyViews props, std::pmr::memory_resource* resource = std::pmr::get_default_resource()) {
+    auto values = ParseFields<Entity>(props);
+    if (!values) {
+        return std::nullopt;
+    }
+    return Schema<Entity>::Construct(*values, resource);
+}
+
+template <typename Entity>
+std::optional<Entity> ParseRecord(const Properties& props, std::pmr::memory_resource* resource = std::pmr::get_default_resource()) {
+    std::vector<std::string_view> views(props.begin(), props.end());
+    return ParseRecord<Entity>(PropertyViews(views), resource);
+}
+
+/**
+ * @brief Parses a record into an entity.
+ * @throws std::invalid_argument if the number of properties is incorrect or a property is invalid.
+ */
+template <typename Entity>
+Entity ParseRecordOrThrow(PropertyViews props, std::pmr::memory_resource* resource = std::pmr::get_default_resource()) {
+    if (props.size() != Schema<Entity>::FieldCount) {
+        throw std::invalid_argument(INVALIDNUMBEROFPROPERTIESMESSAGE);
+    }
+    std::optional<Entity> entity = ParseRecord<Entity>(props, resource);
+    if (!entity) {
+        throw std::invalid_argument(INVALIDPROPERTYMESSAGE);
+    }
+    return std::move(*entity);
+}
+
+/**
+ * @brief Appends the text form of a field of the entity to the buffer.
+ */
+template <typename Entity>
+void AppendField(const Entity& entity, const FieldDescriptor<Entity>& field, std::string& buffer) {
+    switch (field.Type) {
+    case FieldType::Text:
+        buffer += (entity.*field.GetText)();
+        break;
+    case FieldType::Number: {
+        char digits[std::numeric_limits<int>::digits10 + 2];
+        auto [end, error] = std::to_chars(digits, digits + sizeof(digits), (entity.*field.GetNumber)());
+        buffer.append(digits, end);
+        break;
+    }
+    case FieldType::Flag:
+        buffer += (entity.*field.GetFlag)() ? '1' : '0';
+        break;
+    }
+}
+
+/**
+ * @brief Appends the entity to the buffer as one line of a data file.
+ * @param entity The entity to serialize.
+ * @param buffer The buffer the line is appended to.
+ */
+template <typename Entity>
+void SerializeRecord(const Entity& entity, std::string& buffer) {
+    for (size_t i = 0; i < Schema<Entity>::FieldCount; ++i) {
+        if (i != 0) {
+            buffer += DELIMITER;
+        }
+        AppendField(entity, Schema<Entity>::Fields[i], buffer);
+    }
+    buffer += '\n';
+}
+
+/**
+ * @brief Widens the columns of a listing so that the fields of the entity fit in them.
+ * @param entity The listed entity.
+ * @param widths The widths of the columns in the order of the fields.
+ */
+template <typename Entity>
+void WidenColumns(const Entity& entity, std::vector<size_t>& widths) {
+    widths.resize(std::max(widths.size(), Schema<Entity>::FieldCount));
+    std::string field;
+    for (size_t i = 0; i < Schema<Entity>::FieldCount; ++i) {
+        field.clear();
+        AppendField(entity, Schema<Entity>::Fields[i], field);
+        widths[i] = std::max(widths[i], field.size());
+    }
+}
+
+/**
+ * @brief Converts the entity to its properties in the order of its fields.
+ */
+template <typename Entity>
+Properties ToProperties(const Entity& entity) {
+    Properties result(Schema<Entity>::FieldCount);
+    for (size_t i = 0; i < Schema<Entity>::FieldCount; ++i) {
+        AppendField(entity, Schema<Entity>::Fields[i], result[i]);
+    }
+    return result;
+}
+
+#endif // !_SCHEMA_H_
@@ -0,0 +1,15 @@
+#include "SessionRecorder.h"
+
+RecordingBuffer::int_type RecordingBuffer::underflow() {
+	if (!std::getline(Source, Line)) {
+		return traits_type::eof();
+	}
+	if (!Source.eof()) {
+		Line += '\n'; // The last line of the input may have no line ending
+	}
+	Record.write(Line.data(), Line.size());
+	Record.flush();
+
+	setg(Line.data(), Line.data(), Line.data() + Line.size());
+	return traits_type::to_int_type(Line[0]);
+}
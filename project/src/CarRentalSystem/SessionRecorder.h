@@ -0,0 +1,36 @@
+#pragma once
+
+#ifndef _SESSIONRECORDER_H_
+#define _SESSIONRECORDER_H_
+
+#include <istream>
+#include <ostream>
+#include <streambuf>
+#include <string>
+
+constexpr char RECORDOPTION[] = "--record";
+
+/**
+ * @brief An input buffer that passes the lines of another stream through and writes every line it hands out to a record,
+ * so a clerk session can be replayed later (see carrental_replay). The record is flushed after every line,
+ * so it is complete even if the session is interrupted.
+ */
+class RecordingBuffer : public std::streambuf {
+public:
+    /**
+     * @brief Starts recording.
+     * @param source The stream the lines are read from (for example the keyboard).
+     * @param record The stream the read lines are written to.
+     */
+    RecordingBuffer(std::istream& source, std::ostream& record) : Source(source), Record(record) {}
+
+protected:
+    int_type underflow() override;
+
+private:
+    std::istream& Source;
+    std::ostream& Record;
+    std::string Line; // The line being handed out
+};
+
+#endif // !_SESSIONRECORDER_H_
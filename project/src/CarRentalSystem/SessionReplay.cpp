@@ -0,0 +1,207 @@
+// Replays recorded clerk sessions (CarRentalSystem --record <file>) in parallel against a copy of a data directory
+// and reports the latency of every menu action. The console is not cleared and the output of the sessions is discarded.
+// Usage: carrental_replay --data <data directory> [--threads T] [--repeat R] [--histogram file] <session files...>
+// The data directory (for example TestingData/src) is copied into the src directory of the current directory.
+// The data is copied once, so every replay of a recording changes the data the later ones see (a contract that was returned
+// cannot be returned again). Such a replay takes another way through the menus than the recording and is counted as diverged:
+// it runs other actions than the first finished replay of the same recording or leaves keystrokes unread. Its latencies are still reported.
+
+#include "System.h"
+#include "LatencyReport.h"
+#include <atomic>
+#include <cmath>
+#include <iomanip>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <thread>
+
+constexpr int DEFAULTREPLAYTHREADS = 8;
+constexpr int DEFAULTREPLAYREPEATS = 10;
+constexpr size_t HISTOGRAMBUCKETS = 40; // Bucket b counts the latencies below 2^b microseconds that are not in a lower bucket
+constexpr char REPLAYCOPYMARKER[] = ".replay_copy"; // Marks a data directory copied by the replay, only such a directory is replaced
+constexpr char SESSIONACTIONNAME[] = "Session";
+
+/**
+ * @brief An output buffer that discards everything, the frames are still built and written to it.
+ */
+class DiscardBuffer : public std::streambuf {
+protected:
+	int_type overflow(int_type character) override {
+		return traits_type::not_eof(character);
+	}
+
+	std::streamsize xsputn(const char*, std::streamsize count) override {
+		return count;
+	}
+};
+
+/**
+ * @brief The measured latencies (in microseconds) of the actions, by their names.
+ */
+using ActionLatencies = std::map<std::string, std::vector<double>>;
+
+/**
+ * @brief Decides the bucket of the histogram of a latency.
+ */
+static size_t GetBucket(double latency) {
+	size_t bucket = 0;
+	while (bucket + 1 < HISTOGRAMBUCKETS && latency >= std::ldexp(1.0, static_cast<int>(bucket))) {
+		++bucket;
+	}
+	return bucket;
+}
+
+/**
+ * @brief Replaces the data directory of the current directory with a copy of the given one.
+ * @return False if the copy failed or the current data directory is not a previous copy.
+ */
+static bool CopyDataDirectory(const std::filesystem::path& data) {
+	std::error_code error;
+	if (std::filesystem::exists(SOURCEFILES, error)) {
+		if (!std::filesystem::exists(ConcatPaths(SOURCEFILES, REPLAYCOPYMARKER), error)) {
+			std::cerr << SOURCEFILES.string() << " is not a copy made by the replay, run the replay in an empty directory" << std::endl;
+			return false;
+		}
+		std::filesystem::remove_all(SOURCEFILES, error);
+	}
+	std::filesystem::copy(data, SOURCEFILES, std::filesystem::copy_options::recursive, error);
+	if (error) {
+		std::cerr << ERRORMESSAGE << std::endl;
+		return false;
+	}
+	std::ofstream(ConcatPaths(SOURCEFILES, REPLAYCOPYMARKER));
+	// The build creates the directory of the contracts, a data directory from elsewhere may not have it
+	std::filesystem::create_directories(ConcatPaths(SOURCEFILES, CONTRACTSLEDGER).parent_path(), error);
+	return true;
+}
+
+static bool WriteHistograms(const std::filesystem::path& file, const ActionLatencies& latencies) {
+	std::ofstream output(file);
+	if (!output.is_open()) {
+		std::cerr << ERRORMESSAGE << std::endl;
+		return false;
+	}
+	output << "ACTION,UPPER_BOUND_US,COUNT\n";
+	for (const auto& [action, samples] : latencies) {
+		std::vector<size_t> buckets(HISTOGRAMBUCKETS);
+		for (double latency : samples) {
+			++buckets[GetBucket(latency)];
+		}
+		for (size_t bucket = 0; bucket < HISTOGRAMBUCKETS; ++bucket) {
+			if (buckets[bucket] != 0) {
+				output << action << ',' << std::ldexp(1.0, static_cast<int>(bucket)) << ',' << buckets[bucket] << '\n';
+			}
+		}
+	}
+	return static_cast<bool>(output);
+}
+
+int main(int argc, char* argv[]) {
+	int threads = DEFAULTREPLAYTHREADS;
+	int repeats = DEFAULTREPLAYREPEATS;
+	std::filesystem::path data;
+	std::filesystem::path histogramFile;
+	std::vector<std::string> sessions;
+	for (int i = 1; i < argc; ++i) {
+		std::string argument = argv[i];
+		bool hasValue = i + 1 < argc;
+		if (argument == "--threads" && hasValue && TryParseNumber(argv[i + 1], threads) && threads > 0) { ++i; }
+		else if (argument == "--repeat" && hasValue && TryParseNumber(argv[i + 1], repeats) && repeats > 0) { ++i; }
+		else if (argument == "--data" && hasValue) { data = argv[++i]; }
+		else if (argument == "--histogram" && hasValue) { histogramFile = argv[++i]; }
+		else if (argument.starts_with("--")) {
+			std::cerr << "Invalid option " << argument << std::endl;
+			return 1;
+		}
+		else {
+			std::ifstream sessionFile(argument, std::ios_base::binary);
+			if (!sessionFile.is_open()) {
+				std::cerr << ERRORMESSAGE << std::endl;
+				return 1;
+			}
+			sessions.emplace_back(std::istreambuf_iterator<char>(sessionFile), std::istreambuf_iterator<char>());
+		}
+	}
+	if (data.empty() || sessions.empty()) {
+		std::cerr << "Usage: carrental_replay --data <data directory> [--threads T] [--repeat R] [--histogram file] <session files...>" << std::endl;
+		return 1;
+	}
+	if (!CopyDataDirectory(data)) {
+		return 1;
+	}
+
+	// The sessions share the repository and the audit log like the sessions of the server
+	FrameRenderer::SetClearing(false);
+	Repository::Load();
+	AuditLog::Start(ConcatPaths(SOURCEFILES, AUDITLOGDIRECTORY));
+
+	size_t replays = sessions.size() * static_cast<size_t>(repeats);
+	std::atomic<size_t> nextReplay = 0;
+	std::atomic<size_t> diverged = 0;
+	std::vector<std::optional<std::vector<std::string>>> sessionActions(sessions.size()); // The actions of the first replay of every recording
+	std::mutex sessionActionsMutex;
+	std::vector<ActionLatencies> threadLatencies(static_cast<size_t>(threads));
+	std::vector<std::thread> workers;
+	auto start = std::chrono::steady_clock::now();
+	for (auto& latencies : threadLatencies) {
+		workers.emplace_back([&]() {
+			DiscardBuffer discarded;
+			std::ostream output(&discarded);
+			std::vector<std::string> actions;
+			auto record = [&latencies](const std::string& action, std::chrono::steady_clock::duration duration) {
+				latencies[action].push_back(std::chrono::duration<double, std::micro>(duration).count());
+			};
+			auto observe = [&record, &actions](const std::string& action, std::chrono::steady_clock::duration duration) {
+				actions.push_back(action);
+				record(action, duration);
+			};
+			for (size_t replay = nextReplay++; replay < replays; replay = nextReplay++) {
+				size_t recording = replay % sessions.size();
+				std::istringstream input(sessions[recording]);
+				System session(output, input);
+				session.SetActionObserver(observe);
+				actions.clear();
+				auto sessionStart = std::chrono::steady_clock::now();
+				session.RunSession();
+				record(SESSIONACTIONNAME, std::chrono::steady_clock::now() - sessionStart);
+
+				bool unread = !(input >> std::ws).eof();
+				std::lock_guard lock(sessionActionsMutex);
+				if (!sessionActions[recording]) {
+					sessionActions[recording] = actions;
+				}
+				if (unread || *sessionActions[recording] != actions) {
+					++diverged;
+				}
+			}
+			});
+	}
+	for (auto& worker : workers) {
+		worker.join();
+	}
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	AuditLog::Stop();
+
+	ActionLatencies latencies;
+	for (auto& threadLatency : threadLatencies) {
+		for (auto& [action, samples] : threadLatency) {
+			latencies[action].insert(latencies[action].end(), samples.begin(), samples.end());
+		}
+	}
+
+	std::cout << "Sessions: " << replays << " on " << threads << " threads in " << std::fixed << std::setprecision(3) << seconds << " s ("
+		<< std::setprecision(1) << (seconds > 0 ? replays / seconds : 0) << " sessions/s)" << std::endl;
+	if (diverged != 0) {
+		std::cout << "Diverged: " << diverged << " of " << replays << " sessions did not follow their recordings on the changed data" << std::endl;
+	}
+	PrintLatencyHeader(std::cout, "ACTION", "COUNT", false);
+	for (auto& [action, samples] : latencies) {
+		PrintLatencyRow(std::cout, action, SummarizeLatencies(samples));
+	}
+
+	if (!histogramFile.empty() && !WriteHistograms(histogramFile, latencies)) {
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,226 @@
+#include "SessionServer.h"
+#include "System.h"
+#include <csignal>
+#include <cstring>
+#include <cerrno>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+std::atomic<bool> SessionServer::StopRequested = false;
+
+/**
+ * @brief Stops the server on Ctrl+C or when it is terminated.
+ */
+static void HandleStopSignal(int) {
+	SessionServer::RequestStop();
+}
+
+SocketBuffer::SocketBuffer(int socket) : Socket(socket) {
+	setg(Input, Input, Input);
+	setp(Output, Output + sizeof(Output));
+}
+
+SocketBuffer::~SocketBuffer() {
+	SendPending();
+}
+
+SocketBuffer::int_type SocketBuffer::underflow() {
+	if (!SendPending()) {
+		return traits_type::eof();
+	}
+	ssize_t received;
+	do {
+		received = recv(Socket, Input, sizeof(Input), 0);
+	} while (received < 0 && errno == EINTR);
+	if (received <= 0) {
+		return traits_type::eof();
+	}
+	setg(Input, Input, Input + received);
+	return traits_type::to_int_type(Input[0]);
+}
+
+SocketBuffer::int_type SocketBuffer::overflow(int_type character) {
+	if (!SendPending()) {
+		return traits_type::eof();
+	}
+	if (!traits_type::eq_int_type(character, traits_type::eof())) {
+		*pptr() = traits_type::to_char_type(character);
+		pbump(1);
+	}
+	return traits_type::not_eof(character);
+}
+
+int SocketBuffer::sync() {
+	return SendPending() ? 0 : -1;
+}
+
+bool SocketBuffer::SendPending() {
+	for (const char* next = pbase(); next < pptr();) {
+		ssize_t sent = send(Socket, next, pptr() - next, 0);
+		if (sent < 0 && errno == EINTR) {
+			continue;
+		}
+		if (sent <= 0) {
+			setp(Output, Output + sizeof(Output)); // The client is gone, the rest of the output is dropped
+			return false;
+		}
+		next += sent;
+	}
+	setp(Output, Output + sizeof(Output));
+	return true;
+}
+
+SessionServer::SessionServer(const std::filesystem::path& socketPath, size_t workers) : SocketPath(socketPath), WorkerCount(std::max<size_t>(workers, 1)) {}
+
+SessionServer::~SessionServer() {
+	Stop();
+}
+
+bool SessionServer::Start() {
+	sockaddr_un address = {};
+	address.sun_family = AF_UNIX;
+	std::string path = SocketPath.string();
+	if (path.size() >= sizeof(address.sun_path)) {
+		std::cerr << SOCKETERRORMESSAGE << std::endl;
+		return false;
+	}
+	std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+
+	Listener = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (Listener < 0) {
+		std::cerr << SOCKETERRORMESSAGE << std::endl;
+		return false;
+	}
+	// A socket nobody listens on is left by a server that did not stop properly
+	if (connect(Listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0) {
+		close(Listener);
+		Listener = -1;
+		std::cerr << "Another server is already running on " << path << std::endl;
+		return false;
+	}
+	close(Listener);
+	unlink(path.c_str());
+
+	Listener = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (Listener < 0 || bind(Listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || listen(Listener, MAXPENDINGCONNECTIONS) != 0) {
+		std::cerr << SOCKETERRORMESSAGE << std::endl;
+		if (Listener >= 0) {
+			close(Listener);
+			Listener = -1;
+		}
+		return false;
+	}
+
+	// A client that leaves in the middle of a screen must not kill the server
+	std::signal(SIGPIPE, SIG_IGN);
+	// Without SA_RESTART, so the signal interrupts the waiting for a connection
+	struct sigaction stopAction = {};
+	stopAction.sa_handler = HandleStopSignal;
+	sigemptyset(&stopAction.sa_mask);
+	sigaction(SIGINT, &stopAction, nullptr);
+	sigaction(SIGTERM, &stopAction, nullptr);
+	StopRequested = false;
+	Stopping = false;
+
+	// The workers inherit the stop signals blocked, so a signal always interrupts the thread waiting for connections
+	sigset_t stopSignals;
+	sigemptyset(&stopSignals);
+	sigaddset(&stopSignals, SIGINT);
+	sigaddset(&stopSignals, SIGTERM);
+	pthread_sigmask(SIG_BLOCK, &stopSignals, nullptr);
+	Workers.reserve(WorkerCount);
+	for (size_t i = 0; i < WorkerCount; ++i) {
+		Workers.emplace_back(&SessionServer::Work, this);
+	}
+	pthread_sigmask(SIG_UNBLOCK, &stopSignals, nullptr);
+	return true;
+}
+
+void SessionServer::Run() {
+	while (!StopRequested) {
+		int client = accept(Listener, nullptr, nullptr);
+		if (client < 0) {
+			if (errno == EINTR || errno == ECONNABORTED) {
+				continue; // Interrupted by a signal, which may have requested the stop
+			}
+			std::cerr << SOCKETERRORMESSAGE << std::endl;
+			break;
+		}
+
+		std::lock_guard lock(Mutex);
+		if (Busy + Waiting.size() >= WorkerCount) {
+			send(client, SERVERBUSYMESSAGE, sizeof(SERVERBUSYMESSAGE) - 1, 0);
+		}
+		Waiting.push_back(client);
+		ConnectionReady.notify_one();
+	}
+	Stop();
+}
+
+void SessionServer::Stop() {
+	{
+		std::lock_guard lock(Mutex);
+		if (Listener < 0) {
+			return;
+		}
+		Stopping = true;
+		// The sessions read the end of their input and finish like after CANCEL
+		for (int client : Sessions) {
+			shutdown(client, SHUT_RDWR);
+		}
+		for (int client : Waiting) {
+			close(client);
+		}
+		Waiting.clear();
+	}
+	ConnectionReady.notify_all();
+	for (auto& worker : Workers) {
+		worker.join();
+	}
+	Workers.clear();
+
+	close(Listener);
+	Listener = -1;
+	unlink(SocketPath.string().c_str());
+}
+
+void SessionServer::RequestStop() {
+	StopRequested = true;
+}
+
+void SessionServer::Work() {
+	while (true) {
+		int client;
+		{
+			std::unique_lock lock(Mutex);
+			ConnectionReady.wait(lock, [&]() { return Stopping || !Waiting.empty(); });
+			if (Stopping) {
+				return;
+			}
+			client = Waiting.front();
+			Waiting.pop_front();
+			Sessions.insert(client);
+			++Busy;
+		}
+
+		Serve(client);
+
+		std::lock_guard lock(Mutex);
+		Sessions.erase(client);
+		--Busy;
+		close(client);
+	}
+}
+
+void SessionServer::Serve(int client) {
+	SocketBuffer buffer(client);
+	std::iostream stream(&buffer);
+	System session(stream, stream);
+	try {
+		session.RunSession();
+	}
+	catch (...) {
+		std::cerr << UNKNOWNEXCEPTIONMESSAGE << std::endl;
+	}
+}
@@ -0,0 +1,139 @@
+#pragma once
+
+#ifndef _SESSIONSERVER_H_
+#define _SESSIONSERVER_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <streambuf>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+// The command line option of the server mode
+constexpr char SERVEOPTION[] = "--serve";
+
+/**
+ * @brief The socket the server listens on and the client connects to when no other is given.
+ */
+const std::filesystem::path DEFAULTSOCKETPATH = "carrental.sock";
+
+/**
+ * @brief The number of the workers of the server when no other is given, which is the number of sessions served at once.
+ */
+constexpr size_t DEFAULTSESSIONWORKERS = 256;
+
+constexpr size_t SOCKETBUFFERSIZE = 4096;
+constexpr int MAXPENDINGCONNECTIONS = 128;
+
+constexpr char SOCKETERRORMESSAGE[] = "Error opening the socket.";
+constexpr char SERVERBUSYMESSAGE[] = "All the sessions are taken, you will be connected as soon as one is free.\n";
+
+/**
+ * @brief A stream buffer reading from and writing to a connected socket. The pending output is sent
+ * before the buffer waits for input, so a prompt always reaches the other side before its answer is read.
+ */
+class SocketBuffer : public std::streambuf {
+public:
+    /**
+     * @brief Wraps a connected socket, the socket is not closed by the buffer.
+     * @param socket The descriptor of the socket.
+     */
+    explicit SocketBuffer(int socket);
+
+    ~SocketBuffer();
+
+    SocketBuffer(const SocketBuffer&) = delete;
+    SocketBuffer& operator=(const SocketBuffer&) = delete;
+
+protected:
+    int_type underflow() override;
+    int_type overflow(int_type character) override;
+    int sync() override;
+
+private:
+    /**
+     * @brief Sends the whole pending output.
+     * @return False if the socket is closed.
+     */
+    bool SendPending();
+
+    int Socket;
+    char Input[SOCKETBUFFERSIZE];
+    char Output[SOCKETBUFFERSIZE];
+};
+
+/**
+ * @brief Serves the sessions of many clerks over a Unix domain socket. The repository is loaded once and shared by all the sessions.
+ * A fixed pool of workers serves the connections, every worker runs the menus of one session at a time (see System::RunSession)
+ * on a stream over its socket. The connections that come while all the workers are busy wait until one is free.
+ */
+class SessionServer {
+public:
+    /**
+     * @brief Prepares the server, nothing is opened yet.
+     * @param socketPath The path of the socket to listen on.
+     * @param workers The number of the workers.
+     */
+    SessionServer(const std::filesystem::path& socketPath, size_t workers);
+
+    /**
+     * @brief Stops the server if it is still running.
+     */
+    ~SessionServer();
+
+    SessionServer(const SessionServer&) = delete;
+    SessionServer& operator=(const SessionServer&) = delete;
+
+    /**
+     * @brief Starts listening on the socket and starts the workers. A socket left by a server that is not running anymore is replaced.
+     * Ctrl+C (SIGINT) and SIGTERM stop the server from then on. They are blocked in the workers, so Start has to be called
+     * from the thread that calls Run, which is the only one they interrupt.
+     * @return False if the socket could not be opened.
+     */
+    bool Start();
+
+    /**
+     * @brief Accepts the connections until Stop is called, for example from a signal handler (see RequestStop).
+     */
+    void Run();
+
+    /**
+     * @brief Ends all the sessions, waits for the workers and removes the socket.
+     */
+    void Stop();
+
+    /**
+     * @brief Makes Run return as soon as possible. Safe to call from a signal handler.
+     */
+    static void RequestStop();
+
+private:
+    /**
+     * @brief Serves the waiting connections until the server stops.
+     */
+    void Work();
+
+    /**
+     * @brief Runs one session on a connection and closes it.
+     * @param client The descriptor of the connection.
+     */
+    void Serve(int client);
+
+    std::filesystem::path SocketPath;
+    size_t WorkerCount;
+    int Listener = -1;
+    std::vector<std::thread> Workers;
+    std::mutex Mutex; // Guards Waiting, Sessions and Busy
+    std::condition_variable ConnectionReady;
+    std::deque<int> Waiting; // The accepted connections no worker has taken yet
+    std::unordered_set<int> Sessions; // The connections being served, shut down by Stop
+    size_t Busy = 0;
+    bool Stopping = false;
+    static std::atomic<bool> StopRequested;
+};
+
+#endif // !_SESSIONSERVER_H_
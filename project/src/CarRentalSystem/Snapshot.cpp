@@ -0,0 +1,296 @@
+#include "Snapshot.h"
+#include <cstring>
+
+/**
+ * @brief Collects the strings of a snapshot into one table, every distinct string is stored only once.
+ */
+class StringTableBuilder {
+public:
+	SnapshotString Add(std::string_view text) {
+		auto it = Offsets.find(std::string(text));
+		if (it != Offsets.end()) {
+			return { it->second, static_cast<std::uint32_t>(text.size()) };
+		}
+		std::uint32_t offset = static_cast<std::uint32_t>(Table.size());
+		Table.append(text);
+		Offsets.emplace(std::string(text), offset);
+		return { offset, static_cast<std::uint32_t>(text.size()) };
+	}
+
+	const std::string& GetTable() const {
+		return Table;
+	}
+
+private:
+	std::string Table;
+	std::unordered_map<std::string, std::uint32_t> Offsets;
+};
+
+/**
+ * @brief Gives checked access to the parts of a mapped snapshot.
+ */
+class SnapshotReader {
+public:
+	SnapshotReader(const std::filesystem::path& snapshot, SnapshotKind kind, size_t recordSize) : File(snapshot) {
+		std::string_view content = File.GetContent();
+		if (content.size() < sizeof(SnapshotHeader)) {
+			return;
+		}
+		std::memcpy(&Header, content.data(), sizeof(SnapshotHeader));
+		if (std::memcmp(Header.Magic, SNAPSHOTMAGIC, sizeof(SNAPSHOTMAGIC)) != 0 || Header.Version != SNAPSHOTVERSION
+			|| Header.ByteOrder != SNAPSHOTBYTEORDER || Header.Kind != static_cast<std::uint32_t>(kind) || Header.RecordSize != recordSize) {
+			return;
+		}
+		if (Header.RecordCount > content.size() / recordSize || Header.HeaderFieldCount > content.size() / sizeof(SnapshotString)) {
+			return;
+		}
+		RecordsOffset = sizeof(SnapshotHeader) + Header.HeaderFieldCount * sizeof(SnapshotString);
+		TableOffset = RecordsOffset + Header.RecordCount * Header.RecordSize;
+		// Every part has to be inside the file, the sizes are compared without a sum that could wrap around
+		if (RecordsOffset > content.size() || TableOffset > content.size() || Header.StringTableSize != content.size() - TableOffset) {
+			return;
+		}
+		Content = content;
+		Valid = true;
+	}
+
+	bool IsValid() const {
+		return Valid;
+	}
+
+	const SnapshotHeader& GetHeader() const {
+		return Header;
+	}
+
+	template <typename Record>
+	Record GetRecord(size_t index) const {
+		Record record;
+		std::memcpy(&record, Content.data() + RecordsOffset + index * sizeof(Record), sizeof(Record));
+		return record;
+	}
+
+	Properties GetTextHeader() const {
+		Properties result;
+		for (size_t i = 0; i < Header.HeaderFieldCount; ++i) {
+			SnapshotString field;
+			std::memcpy(&field, Content.data() + sizeof(SnapshotHeader) + i * sizeof(SnapshotString), sizeof(SnapshotString));
+			result.emplace_back(GetString(field));
+		}
+		return result;
+	}
+
+	/**
+	 * @throws std::out_of_range if the string is not inside the string table.
+	 */
+	std::string_view GetString(SnapshotString text) const {
+		if (static_cast<std::uint64_t>(text.Offset) + text.Length > Header.StringTableSize) {
+			throw std::out_of_range("Corrupted snapshot");
+		}
+		return Content.substr(TableOffset + text.Offset, text.Length);
+	}
+
+private:
+	MappedFile File;
+	SnapshotHeader Header = {};
+	std::string_view Content;
+	size_t RecordsOffset = 0;
+	size_t TableOffset = 0;
+	bool Valid = false;
+};
+
+/**
+ * @brief Writes the whole snapshot with one write into a temporary file which then replaces the snapshot.
+ */
+static void WriteSnapshot(const std::filesystem::path& snapshot, SnapshotKind kind, const Properties& textHeader,
+	const std::string& records, size_t recordSize, size_t recordCount, StringTableBuilder& strings) {
+	std::vector<SnapshotString> headerFields;
+	for (const auto& field : textHeader) {
+		headerFields.push_back(strings.Add(field));
+	}
+
+	SnapshotHeader header = {};
+	std::memcpy(header.Magic, SNAPSHOTMAGIC, sizeof(SNAPSHOTMAGIC));
+	header.Version = SNAPSHOTVERSION;
+	header.ByteOrder = SNAPSHOTBYTEORDER;
+	header.Kind = static_cast<std::uint32_t>(kind);
+	header.HeaderFieldCount = static_cast<std::uint32_t>(headerFields.size());
+	header.RecordSize = static_cast<std::uint32_t>(recordSize);
+	header.RecordCount = recordCount;
+	header.StringTableSize = strings.GetTable().size();
+
+	std::string buffer;
+	buffer.reserve(sizeof(header) + headerFields.size() * sizeof(SnapshotString) + records.size() + strings.GetTable().size());
+	buffer.append(reinterpret_cast<const char*>(&header), sizeof(header));
+	buffer.append(reinterpret_cast<const char*>(headerFields.data()), headerFields.size() * sizeof(SnapshotString));
+	buffer.append(records);
+	buffer.append(strings.GetTable());
+
+	std::filesystem::path temporaryPath = snapshot;
+	temporaryPath += ".tmp";
+	std::ofstream outputFile(temporaryPath, std::ios_base::binary | std::ios_base::trunc);
+	if (!outputFile.is_open()) {
+		std::cerr << ERRORMESSAGE << std::endl;
+		return;
+	}
+	outputFile.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+	outputFile.close();
+
+	std::error_code error;
+	std::filesystem::rename(temporaryPath, snapshot, error);
+	if (error) {
+		std::filesystem::remove(temporaryPath, error);
+	}
+}
+
+template <typename Record>
+static void AppendRecord(std::string& records, const Record& record) {
+	records.append(reinterpret_cast<const char*>(&record), sizeof(Record));
+}
+
+bool Snapshot::IsUpToDate(const std::filesystem::path& snapshot, const std::vector<std::filesystem::path>& sources) {
+	std::error_code error;
+	auto snapshotTime = std::filesystem::last_write_time(snapshot, error);
+	if (error) {
+		return false;
+	}
+	for (const auto& source : sources) {
+		for (const auto& path : { source, GetJournalPath(source) }) {
+			if (!std::filesystem::exists(path, error)) {
+				continue;
+			}
+			auto sourceTime = std::filesystem::last_write_time(path, error);
+			if (error || sourceTime >= snapshotTime) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+bool Snapshot::LoadCars(const std::filesystem::path& snapshot, Properties& header, std::vector<Car>& cars, std::vector<CarStatus>& statuses) {
+	SnapshotReader reader(snapshot, SnapshotKind::Cars, sizeof(SnapshotCar));
+	if (!reader.IsValid()) {
+		return false;
+	}
+
+	std::vector<Car> loadedCars;
+	std::vector<CarStatus> loadedStatuses;
+	try {
+		loadedCars.reserve(reader.GetHeader().RecordCount);
+		loadedStatuses.reserve(reader.GetHeader().RecordCount);
+		for (size_t i = 0; i < reader.GetHeader().RecordCount; ++i) {
+			SnapshotCar record = reader.GetRecord<SnapshotCar>(i);
+			if (record.Status >= NUMBEROFCARSTATUSES) {
+				return false; // A damaged snapshot, the cars are loaded from their files instead
+			}
+			loadedCars.emplace_back(reader.GetString(record.Make), reader.GetString(record.Model), record.Year, reader.GetString(record.Color),
+				reader.GetString(record.LicencePlate), reader.GetString(record.Motorization), reader.GetString(record.Gearbox), record.Seats, record.CostPerHour);
+			loadedStatuses.push_back(static_cast<CarStatus>(record.Status));
+		}
+		header = reader.GetTextHeader();
+	}
+	catch (const std::exception&) {
+		return false;
+	}
+
+	cars = std::move(loadedCars);
+	statuses = std::move(loadedStatuses);
+	return true;
+}
+
+bool Snapshot::LoadCustomers(const std::filesystem::path& snapshot, Properties& header, std::vector<Customer>& customers, std::pmr::memory_resource* resource) {
+	SnapshotReader reader(snapshot, SnapshotKind::Customers, sizeof(SnapshotCustomer));
+	if (!reader.IsValid()) {
+		return false;
+	}
+
+	std::vector<Customer> loadedCustomers;
+	try {
+		loadedCustomers.reserve(reader.GetHeader().RecordCount);
+		for (size_t i = 0; i < reader.GetHeader().RecordCount; ++i) {
+			SnapshotCustomer record = reader.GetRecord<SnapshotCustomer>(i);
+			loadedCustomers.emplace_back(reader.GetString(record.Name), reader.GetString(record.Surname),
+				reader.GetString(record.EmailAdress), reader.GetString(record.Phone), reader.GetString(record.Adress), resource);
+		}
+		header = reader.GetTextHeader();
+	}
+	catch (const std::exception&) {
+		return false;
+	}
+
+	customers = std::move(loadedCustomers);
+	return true;
+}
+
+bool Snapshot::LoadUsers(const std::filesystem::path& snapshot, std::vector<User>& users, std::pmr::memory_resource* resource) {
+	SnapshotReader reader(snapshot, SnapshotKind::Users, sizeof(SnapshotUser));
+	if (!reader.IsValid()) {
+		return false;
+	}
+
+	std::vector<User> loadedUsers;
+	try {
+		loadedUsers.reserve(reader.GetHeader().RecordCount);
+		for (size_t i = 0; i < reader.GetHeader().RecordCount; ++i) {
+			SnapshotUser record = reader.GetRecord<SnapshotUser>(i);
+			loadedUsers.emplace_back(reader.GetString(record.Username), reader.GetString(record.Password), record.Admin != 0, resource);
+		}
+	}
+	catch (const std::exception&) {
+		return false;
+	}
+
+	users = std::move(loadedUsers);
+	return true;
+}
+
+void Snapshot::SaveCars(const std::filesystem::path& snapshot, const Properties& header, const std::vector<Car>& cars, const std::vector<CarStatus>& statuses) {
+	StringTableBuilder strings;
+	std::string records;
+	records.reserve(cars.size() * sizeof(SnapshotCar));
+	for (size_t i = 0; i < cars.size(); ++i) {
+		const Car& car = cars[i];
+		SnapshotCar record = {};
+		record.Make = strings.Add(car.GetMake());
+		record.Model = strings.Add(car.GetModel());
+		record.Color = strings.Add(car.GetColor());
+		record.LicencePlate = strings.Add(car.GetLicencePlate());
+		record.Motorization = strings.Add(car.GetMotorization());
+		record.Gearbox = strings.Add(car.GetGearbox());
+		record.Year = car.GetYear();
+		record.Seats = car.GetSeats();
+		record.CostPerHour = car.GetCostPerHour();
+		record.Status = static_cast<std::uint32_t>(statuses[i]);
+		AppendRecord(records, record);
+	}
+	WriteSnapshot(snapshot, SnapshotKind::Cars, header, records, sizeof(SnapshotCar), cars.size(), strings);
+}
+
+void Snapshot::SaveCustomers(const std::filesystem::path& snapshot, const Properties& header, const std::vector<Customer>& customers) {
+	StringTableBuilder strings;
+	std::string records;
+	records.reserve(customers.size() * sizeof(SnapshotCustomer));
+	for (const auto& customer : customers) {
+		SnapshotCustomer record = {};
+		record.Name = strings.Add(customer.GetName());
+		record.Surname = strings.Add(customer.GetSurname());
+		record.EmailAdress = strings.Add(customer.GetEmailAdress());
+		record.Phone = strings.Add(customer.GetPhone());
+		record.Adress = strings.Add(customer.GetAdress());
+		AppendRecord(records, record);
+	}
+	WriteSnapshot(snapshot, SnapshotKind::Customers, header, records, sizeof(SnapshotCustomer), customers.size(), strings);
+}
+
+void Snapshot::SaveUsers(const std::filesystem::path& snapshot, const std::vector<User>& users) {
+	StringTableBuilder strings;
+	std::string records;
+	for (const auto& user : users) {
+		SnapshotUser record = {};
+		record.Username = strings.Add(user.GetUsername());
+		record.Password = strings.Add(user.GetPassword());
+		record.Admin = user.GetAdminStatus() ? 1 : 0;
+		AppendRecord(records, record);
+	}
+	WriteSnapshot(snapshot, SnapshotKind::Users, Properties(), records, sizeof(SnapshotUser), users.size(), strings);
+}
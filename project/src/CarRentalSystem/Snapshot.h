@@ -0,0 +1,151 @@
+#pragma once
+
+#ifndef _SNAPSHOT_H_
+#define _SNAPSHOT_H_
+
+#include <cstdint>
+#include "FileHandler.h"
+
+const std::filesystem::path CARSSNAPSHOT = "Cars/cars.snapshot";
+const std::filesystem::path CUSTOMERSSNAPSHOT = "Customers/customers.snapshot";
+const std::filesystem::path USERSSNAPSHOT = "Users/users.snapshot";
+
+constexpr char SNAPSHOTMAGIC[8] = { 'C', 'R', 'S', 'S', 'N', 'A', 'P', '\0' };
+constexpr std::uint32_t SNAPSHOTVERSION = 1;
+constexpr std::uint32_t SNAPSHOTBYTEORDER = 0x01020304; // Snapshots are written in the native byte order and rejected on a machine with another one
+
+/**
+ * @brief The kind of records stored in a snapshot.
+ */
+enum class SnapshotKind : std::uint32_t { Cars, Customers, Users };
+
+/**
+ * @brief The header at the beginning of every snapshot file.
+ * The header is followed by HeaderFieldCount string references (the header of the text file),
+ * then by RecordCount fixed-width records and finally by the string table.
+ */
+struct SnapshotHeader {
+    char Magic[8];
+    std::uint32_t Version;
+    std::uint32_t ByteOrder;
+    std::uint32_t Kind;
+    std::uint32_t HeaderFieldCount;
+    std::uint32_t RecordSize;
+    std::uint32_t Reserved;
+    std::uint64_t RecordCount;
+    std::uint64_t StringTableSize;
+};
+
+/**
+ * @brief A reference to a string in the string table of a snapshot.
+ */
+struct SnapshotString {
+    std::uint32_t Offset;
+    std::uint32_t Length;
+};
+
+/**
+ * @brief A car as it is stored in a snapshot.
+ */
+struct SnapshotCar {
+    SnapshotString Make;
+    SnapshotString Model;
+    SnapshotString Color;
+    SnapshotString LicencePlate;
+    SnapshotString Motorization;
+    SnapshotString Gearbox;
+    std::int32_t Year;
+    std::int32_t Seats;
+    std::int32_t CostPerHour;
+    std::uint32_t Status;
+};
+
+/**
+ * @brief A customer as it is stored in a snapshot.
+ */
+struct SnapshotCustomer {
+    SnapshotString Name;
+    SnapshotString Surname;
+    SnapshotString EmailAdress;
+    SnapshotString Phone;
+    SnapshotString Adress;
+};
+
+/**
+ * @brief A user as it is stored in a snapshot.
+ */
+struct SnapshotUser {
+    SnapshotString Username;
+    SnapshotString Password;
+    std::uint32_t Admin;
+};
+
+/**
+ * @brief Reads and writes the binary snapshots of the data files. The text files stay the source of truth,
+ * a snapshot is only used when it is newer than all the files it was made from.
+ */
+class Snapshot {
+public:
+    /**
+     * @brief Decides if the snapshot is newer than all the given source files (and their journals).
+     * @param snapshot The path of the snapshot.
+     * @param sources The paths of the text files the snapshot was made from.
+     * @return True if the snapshot can be used instead of the source files.
+     */
+    static bool IsUpToDate(const std::filesystem::path& snapshot, const std::vector<std::filesystem::path>& sources);
+
+    /**
+     * @brief Loads cars from a snapshot. The output parameters are left untouched if the snapshot is missing or invalid.
+     * @param snapshot The path of the snapshot.
+     * @param header The header of the text files.
+     * @param cars The loaded cars.
+     * @param statuses The statuses of the loaded cars.
+     * @return True if the snapshot was loaded.
+     */
+    static bool LoadCars(const std::filesystem::path& snapshot, Properties& header, std::vector<Car>& cars, std::vector<CarStatus>& statuses);
+
+    /**
+     * @brief Loads customers from a snapshot. The output parameters are left untouched if the snapshot is missing or invalid.
+     * @param snapshot The path of the snapshot.
+     * @param header The header of the text file.
+     * @param customers The loaded customers.
+     * @param resource The memory resource the strings of the customers are allocated from.
+     * @return True if the snapshot was loaded.
+     */
+    static bool LoadCustomers(const std::filesystem::path& snapshot, Properties& header, std::vector<Customer>& customers, std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+    /**
+     * @brief Loads users from a snapshot. The output parameter is left untouched if the snapshot is missing or invalid.
+     * @param snapshot The path of the snapshot.
+     * @param users The loaded users.
+     * @param resource The memory resource the strings of the users are allocated from.
+     * @return True if the snapshot was loaded.
+     */
+    static bool LoadUsers(const std::filesystem::path& snapshot, std::vector<User>& users, std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+    /**
+     * @brief Writes cars to a snapshot.
+     * @param snapshot The path of the snapshot.
+     * @param header The header of the text files.
+     * @param cars The cars to write.
+     * @param statuses The statuses of the cars.
+     */
+    static void SaveCars(const std::filesystem::path& snapshot, const Properties& header, const std::vector<Car>& cars, const std::vector<CarStatus>& statuses);
+
+    /**
+     * @brief Writes customers to a snapshot.
+     * @param snapshot The path of the snapshot.
+     * @param header The header of the text file.
+     * @param customers The customers to write.
+     */
+    static void SaveCustomers(const std::filesystem::path& snapshot, const Properties& header, const std::vector<Customer>& customers);
+
+    /**
+     * @brief Writes users to a snapshot.
+     * @param snapshot The path of the snapshot.
+     * @param users The users to write.
+     */
+    static void SaveUsers(const std::filesystem::path& snapshot, const std::vector<User>& users);
+};
+
+#endif // !_SNAPSHOT_H_
@@ -2,8 +2,15 @@
 
 
 void System::Run() {
+	Repository::Load();
+	RunSession();
+}
+
+void System::RunSession() {
 	// Let the user log in
-	if (!LogIn()) {
+	bool loggedIn = false;
+	TimeAction(LOGINACTIONNAME, [&]() { loggedIn = LogIn(); });
+	if (!loggedIn) {
 		ClearAndDisplay([&]() { ConsoleController::DisplayGoodByeMessage(output); });
 		return;
 	}
@@ -12,28 +19,32 @@ void System::Run() {
 	std::vector<std::string> chosenMenuOptions = user.GetAdminStatus() ? AdminMenuOptions : MenuOptions;
 	std::vector<std::string> chosenCarMenuOptions = user.GetAdminStatus() ? AdminCarMenuOptions : CarMenuOptions;
 
-	int delayedContractsNumber = CheckContractDates();
 	bool exitRequested = false;
 
 	// Main loop
 	try {
-		while (!exitRequested) {
+		while (!exitRequested && input) {
 
-			int chosenOption = DisplayMenuAndGetChoice(chosenMenuOptions, true, delayedContractsNumber);
+			// The delayed contracts are counted again for every render, so the counter is never stale
+			Repository::UpdateCarStatuses();
+			int chosenOption = -1;
+			TimeAction(MAINMENUACTIONNAME, [&]() { chosenOption = DisplayMenuAndGetChoice(chosenMenuOptions, true, Repository::GetDelayedContractsCount()); });
 
 			std::vector<std::function<void()>> actions = {
 				[&]() { ConsoleController::DisplayGoodByeMessage(output); exitRequested = true; },  // Case 0
 				[&]() { CarsMenu(chosenCarMenuOptions); },
 				[&]() { CustomersMenu(); },
-				[&]() { ConsoleController::DisplayActiveContracts(output); ConsoleController::GetIntInput(output, input, 0, numOfChoisesInDisplay); },
+				[&]() { ShowContracts(ContractState::Active); },
 				[&]() { CreateNewContract(); },
+				[&]() { CreateReservation(); },
 				[&]() { ArchiveContract(); },
 				[&]() { AddUser(); },
-				[&]() { ConsoleController::DisplayArchivedContracts(output); ConsoleController::GetIntInput(output, input, 0, numOfChoisesInDisplay); }
+				[&]() { ShowContracts(ContractState::Archived); },
+				[&]() { ShowReports(); }
 			};
 
 			if (chosenOption >= 0 && chosenOption < actions.size()) {
-				actions[chosenOption]();  // Execute the corresponding action
+				TimeAction(MenuActionNames[chosenOption], actions[chosenOption]);  // Execute the corresponding action
 			}
 
 		}
@@ -45,12 +56,176 @@ void System::Run() {
 
 }
 
+size_t System::RunBatch() {
+	Repository::Load();
+	user = User(BATCHUSERNAME, "", false); // The audited user of the batch commands
+
+	size_t lineNumber = 0;
+	size_t failed = 0;
+	std::string line;
+	std::string message;
+	while (std::getline(input, line)) {
+		++lineNumber;
+		if (!line.empty() && line.back() == '\r') {
+			line.pop_back();
+		}
+
+		std::vector<std::string> command;
+		std::istringstream words(line);
+		for (std::string word; words >> word;) {
+			command.push_back(word);
+		}
+		if (command.empty() || command[0].starts_with('#')) {
+			continue;
+		}
+
+		message.clear();
+		Repository::UpdateCarStatuses();
+		if (RunBatchCommand(command, message)) {
+			output << BATCHOKMESSAGE << ' ' << lineNumber << ' ' << message << '\n';
+		}
+		else {
+			output << BATCHERRORMESSAGE << ' ' << lineNumber << ' ' << message << '\n';
+			++failed;
+		}
+	}
+	output.flush();
+	return failed;
+}
+
+bool System::RunBatchCommand(const std::vector<std::string>& command, std::string& message) const {
+	static const std::unordered_map<std::string, CarStatus> statuses = {
+		{ "available", CarStatus::Available }, { "rented", CarStatus::Rented },
+		{ "serviced", CarStatus::Serviced }, { "unavailable", CarStatus::PermanentlyUnavailable }
+	};
+
+	if (command[0] == "rent" && command.size() == 4) {
+		std::optional<Car> car = Repository::FindCar(CarStatus::Available, command[1]);
+		if (!car) {
+			message = "No available car " + command[1];
+			return false;
+		}
+		std::optional<Customer> customer = Repository::FindCustomer(command[2]);
+		if (!customer) {
+			message = "No customer " + command[2];
+			return false;
+		}
+		std::optional<std::chrono::system_clock::time_point> dueDate = ParseBatchDueDate(command[3]);
+		if (!dueDate) {
+			message = "Invalid due date " + command[3];
+			return false;
+		}
+		std::chrono::system_clock::time_point now = std::chrono::system_clock::now();
+		if (!Repository::IsCarFree(command[1], now, *dueDate)) {
+			message = "Car " + command[1] + " is booked before the due date";
+			return false;
+		}
+		ContractId id = Repository::CreateContract(*customer, *car, now, *dueDate);
+		if (id == 0) {
+			message = ERRORMESSAGE;
+			return false;
+		}
+		Audit(AuditAction::CreateContract, command[1], id);
+		message = "contract " + std::to_string(id);
+		return true;
+	}
+
+	if (command[0] == "reserve" && command.size() == 5) {
+		std::optional<CarStatus> status = Repository::GetCarStatus(command[1]);
+		if (status != CarStatus::Available && status != CarStatus::Rented) {
+			message = "No car to reserve " + command[1];
+			return false;
+		}
+		std::optional<Customer> customer = Repository::FindCustomer(command[2]);
+		if (!customer) {
+			message = "No customer " + command[2];
+			return false;
+		}
+		std::optional<std::chrono::system_clock::time_point> start = ParseBatchDueDate(command[3]);
+		std::optional<std::chrono::system_clock::time_point> end = ParseBatchDueDate(command[4]);
+		if (!start || !end || *end <= *start) {
+			message = "Invalid period " + command[3] + " " + command[4];
+			return false;
+		}
+		if (!Repository::IsCarFree(command[1], *start, *end)) {
+			message = "Car " + command[1] + " is already booked in the period";
+			return false;
+		}
+		ContractId id = Repository::CreateContract(*customer, *Repository::FindCar(*status, command[1]), *start, *end);
+		if (id == 0) {
+			message = ERRORMESSAGE;
+			return false;
+		}
+		Audit(AuditAction::CreateReservation, command[1], id);
+		message = "contract " + std::to_string(id);
+		return true;
+	}
+
+	if (command[0] == "return" && command.size() == 2) {
+		ContractId id = FindContractId(command[1], ContractState::Active);
+		if (id == 0) {
+			message = "No active contract " + command[1];
+			return false;
+		}
+		std::optional<ContractRecord> contract = Repository::FindContract(id);
+		if (!Repository::ArchiveContract(id)) {
+			message = ERRORMESSAGE;
+			return false;
+		}
+		Audit(AuditAction::ArchiveContract, contract ? contract->GetLicencePlate() : std::string_view(), id);
+		message = "contract " + std::to_string(id);
+		return true;
+	}
+
+	if (command[0] == "move" && command.size() == 3) {
+		std::optional<CarStatus> from = Repository::GetCarStatus(command[1]);
+		auto to = statuses.find(command[2]);
+		if (!from || to == statuses.end()) {
+			message = !from ? "No car " + command[1] : "Invalid status " + command[2];
+			return false;
+		}
+		// Another session may have moved the car since its status was read
+		if (!Repository::MoveCar(command[1], *from, to->second)) {
+			message = "Car " + command[1] + " was not moved";
+			return false;
+		}
+		Audit(AuditAction::MoveCar, command[1], 0, static_cast<std::uint8_t>(*from), static_cast<std::uint8_t>(to->second));
+		message = command[1] + " " + command[2];
+		return true;
+	}
+
+	message = "Unknown command";
+	return false;
+}
+
+std::optional<std::chrono::system_clock::time_point> System::ParseBatchDueDate(std::string_view text) {
+	// YYYY-MM-DDTHH:MM, every part is a number followed by its separator
+	constexpr char separators[] = { '-', '-', 'T', ':', '\0' };
+	int parts[5] = {};
+	for (size_t i = 0; i < 5; ++i) {
+		size_t end = i == 4 ? text.size() : text.find(separators[i]);
+		if (end == std::string_view::npos || !TryParseNumber(text.substr(0, end), parts[i])) {
+			return std::nullopt;
+		}
+		text.remove_prefix(i == 4 ? end : end + 1);
+	}
+	if (parts[1] < 1 || parts[1] > 12 || parts[2] < 1 || parts[2] > 31 || parts[3] < 0 || parts[3] > 23 || parts[4] < 0 || parts[4] > 59) {
+		return std::nullopt;
+	}
+
+	// The same limits as for a contract created in the menus
+	std::optional<std::chrono::system_clock::time_point> dueDate = MakeLocalTimePoint(parts[0], parts[1], parts[2], parts[3], parts[4]);
+	std::chrono::system_clock::time_point now = std::chrono::system_clock::now();
+	if (!dueDate || *dueDate <= now || *dueDate > now + std::chrono::years(MAXYEARSOFRENT + 1)) {
+		return std::nullopt;
+	}
+	return dueDate;
+}
+
 bool System::LogIn() {
 	ConsoleController::ClearConsole(); // This has to be here in case the user runs the program from console
 	ConsoleController::DisplayLogInMenu(output);
 
-	StorageVector users = FileReader::GetUsers();
-
 	ConsoleController::PrintMessage(output, "Username: ");
 
 	std::string username = ConsoleController::GetStringInput(input);
@@ -61,11 +236,9 @@ bool System::LogIn() {
 			return false;
 		}
 
-		auto it = std::find_if(users.begin(), users.end(), [&username](const std::vector<std::string>& user) {
-			return !user.empty() && user[0] == username;
-			});
+		std::optional<User> foundUser = Repository::FindUser(username);
 
-		if (it != users.end()) {
+		if (foundUser) {
 			ConsoleController::PrintMessage(output, "Password: ");
 			std::string password = ConsoleController::GetStringInput(input);
 
@@ -74,8 +247,9 @@ bool System::LogIn() {
 					return false;
 				}
 
-				if ((*it)[1] == password) {
-					user = User(*it);
+				if (foundUser->GetPassword() == password) {
+					user = *foundUser;
+					Audit(AuditAction::LogIn, username);
 					return true;
 				}
 				else {
@@ -94,42 +268,48 @@ bool System::LogIn() {
 }
 
 void System::AddCar(CarStatus status) const {
-	Properties givenProps = GetPropsFromInput(CARSCOLUMNSNAMES);
+	Properties givenProps = GetPropsFromInput(CARSCOLUMNSNAMES.data(), Schema<Car>::FieldCount);
 	if (givenProps.empty()) return;
 
-	switch (status) {
-	case Available:
-		FileWriter::AddCar(givenProps, CarStatus::Available);
-		break;
-	case Serviced:
-		FileWriter::AddCar(givenProps, CarStatus::Serviced);
-		break;
-	case Rented:
-		FileWriter::AddCar(givenProps, CarStatus::Rented);
-		break;
-	case PermanentlyUnavailable:
-		FileWriter::AddCar(givenProps, CarStatus::PermanentlyUnavailable);
-		break;
+	std::optional<Car> car = ParseRecord<Car>(givenProps);
+	if (!car) {
+		ShowFailure(INVALIDCARMESSAGE);
+		return;
+	}
+	if (!Repository::AddCar(*car, status)) {
+		ShowFailure(DUPLICATECARMESSAGE);
+		return;
 	}
+	Audit(AuditAction::AddCar, car->GetLicencePlate(), 0, NOAUDITSTATUS, static_cast<std::uint8_t>(status));
 }
 
 void System::AddCustomer() const {
-	Properties givenProps = GetPropsFromInput(CUSTOMERSCOLUMNSNAMES);
+	Properties givenProps = GetPropsFromInput(CUSTOMERSCOLUMNSNAMES.data(), Schema<Customer>::FieldCount);
 	if (givenProps.size() != 0) {
-		FileWriter::AddCustomer(givenProps);
+		Customer customer = *ParseRecord<Customer>(givenProps); // Text fields are always valid
+		if (!Repository::AddCustomer(customer)) {
+			ShowFailure(DUPLICATECUSTOMERMESSAGE);
+			return;
+		}
+		Audit(AuditAction::AddCustomer, customer.GetPhone());
 	}
 }
 
 void System::AddUser() const {
-	Properties givenProps = GetPropsFromInput(USERCOLUMNSNAMES);
+	Properties givenProps = GetPropsFromInput(USERCOLUMNSNAMES.data(), Schema<User>::FieldCount);
 	if (givenProps.size() != 0) {
-		FileWriter::AddUser(givenProps);
+		User newUser = *ParseRecord<User>(givenProps);
+		Repository::AddUser(newUser);
+		Audit(AuditAction::AddUser, newUser.GetUsername());
 	}
 }
 
-std::vector<int> System::GetContractProperties() const {
+std::vector<int> System::GetContractProperties(const char* hint) const {
 	std::vector<int> dateProps;
 	ConsoleController::DisplayAddingMessage(output, DATECOLUMNSNAMES);
+	if (hint != nullptr) {
+		ConsoleController::PrintMessage(output, hint);
+	}
 	int words = CountWords(DATECOLUMNSNAMES);
 
 
@@ -166,16 +346,18 @@ std::vector<int> System::GetContractProperties() const {
 	return dateProps;
 }
 
-Properties System::GetPropsFromInput(const char* namesOfProps) const {
+Properties System::GetPropsFromInput(const char* namesOfProps, size_t numberOfProps, const char* hint) const {
 	Properties givenProps;
 	ConsoleController::DisplayAddingMessage(output, namesOfProps);
-	int words = CountWords(namesOfProps);
+	if (hint != nullptr) {
+		ConsoleController::PrintMessage(output, hint);
+	}
 
 	input.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
 
 	std::string property;
 
-	for (int i = 0; i < words; ++i) {
+	for (size_t i = 0; i < numberOfProps; ++i) {
 		property = ConsoleController::GetStringInput(input);
 		if (property == "CANCEL") {
 			givenProps.clear();
@@ -204,16 +386,17 @@ void System::CarsMenu(const std::vector<std::string>& chosenCarMenuOptions) cons
 
 	std::vector<std::function<void()>> actions = {
 		[]() { /* Do nothing */ },
-		[&]() {	ConsoleController::DisplayCars(output,CarStatus::Available); ConsoleController::GetIntInput(output, input, 0, numOfChoisesInDisplay); },
-		[&]() {	ConsoleController::DisplayCars(output,CarStatus::Rented);ConsoleController::GetIntInput(output, input, 0, numOfChoisesInDisplay); },
-		[&]() {	ConsoleController::DisplayCars(output,CarStatus::Serviced);	ConsoleController::GetIntInput(output, input, 0, numOfChoisesInDisplay); },
-		[&]() {	ConsoleController::DisplayCars(output,CarStatus::PermanentlyUnavailable); ConsoleController::GetIntInput(output, input, 0, numOfChoisesInDisplay); },
+		[&]() {	ShowPages([&](size_t page) { return ConsoleController::DisplayCars(output, CarStatus::Available, page); }); },
+		[&]() {	ShowPages([&](size_t page) { return ConsoleController::DisplayCars(output, CarStatus::Rented, page); }); },
+		[&]() {	ShowPages([&](size_t page) { return ConsoleController::DisplayCars(output, CarStatus::Serviced, page); }); },
+		[&]() {	ShowPages([&](size_t page) { return ConsoleController::DisplayCars(output, CarStatus::PermanentlyUnavailable, page); }); },
+		[&]() { SearchCars(); },
 		[&]() { AddNewCarMenu(); },
 		[&]() { MoveACar(); }
 	};
 
 	if (chosenCarMenuOption >= 0 && chosenCarMenuOption < actions.size()) {
-		actions[chosenCarMenuOption]();
+		TimeAction(CarMenuActionNames[chosenCarMenuOption], actions[chosenCarMenuOption]);
 	}
 }
 
@@ -239,8 +422,9 @@ void System::CustomersMenu() const {
 
 	std::vector<std::function<void()>> actions = {
 		[]() { /* Do nothing */ },
-		[&]() {	ConsoleController::DisplayCustomers(output); ConsoleController::GetIntInput(output, input, 0, numOfChoisesInDisplay); },
-		[&]() {	AddCustomer(); }
+		[&]() {	ShowPages([&](size_t page) { return ConsoleController::DisplayCustomers(output, page); }); },
+		[&]() {	AddCustomer(); },
+		[&]() {	SearchContractsMenu(); }
 	};
 
 	if (chosenCustomerMenuOption >= 0 && chosenCustomerMenuOption < actions.size()) {
@@ -248,36 +432,169 @@ void System::CustomersMenu() const {
 	}
 }
 
-void System::CreateNewContract() const {
-	ConsoleController::DisplayCars(output,CarStatus::Available);
+void System::ShowReports() const {
+	// The view does not change while the pages are shown, so all of them describe the same moment
+	std::shared_ptr<const ReadView> view = Repository::GetReadView();
+	StorageVector months = Reports::SummarizeMonths(*view);
+	ShowPages([&](size_t page) { return ConsoleController::DisplayReports(output, *view, months, page); });
+}
+
+void System::SearchCars() const {
+	Properties givenProps = GetPropsFromInput(CARSEARCHCOLUMNSNAMES, CountWords(CARSEARCHCOLUMNSNAMES), CARSEARCHHINT);
+	if (givenProps.empty()) return;
+
+	std::optional<FleetQuery> query = CreateCarQuery(givenProps);
+	if (!query) {
+		ShowFailure(INVALIDSEARCHMESSAGE);
+		return;
+	}
+
+	StorageVector cars = Repository::SelectCars(*query);
+	ConsoleController::ClearConsole();
+	ShowPages([&](size_t page) { return ConsoleController::DisplayListing(output, "Available cars found", cars, page); });
+}
+
+std::optional<FleetQuery> System::CreateCarQuery(const Properties& props) {
+	FleetQuery query;
+	query.Status = CarStatus::Available;
+
+	std::optional<std::string>* texts[] = { &query.Make, &query.Model, &query.Motorization, &query.Gearbox };
+	for (size_t i = 0; i < std::size(texts); ++i) {
+		if (props[i] != ANYVALUE) {
+			*texts[i] = props[i];
+		}
+	}
+
+	// The number of seats is one value, the other numbers are the bounds of ranges
+	int* bounds[] = { &query.MinSeats, &query.MinYear, &query.MaxYear, &query.MinCostPerHour, &query.MaxCostPerHour };
+	for (size_t i = 0; i < std::size(bounds); ++i) {
+		const std::string& prop = props[std::size(texts) + i];
+		if (prop != ANYVALUE && !TryParseNumber(prop, *bounds[i])) {
+			return std::nullopt;
+		}
+	}
+	if (props[std::size(texts)] != ANYVALUE) {
+		query.MaxSeats = query.MinSeats;
+	}
+
+	std::string_view sortBy = props.back();
+	query.Descending = sortBy.starts_with('-');
+	if (query.Descending) {
+		sortBy.remove_prefix(1);
+	}
+	if (sortBy == "COST_PER_HOUR") {
+		query.SortBy = FleetSortKey::CostPerHour;
+	}
+	else if (sortBy == "YEAR") {
+		query.SortBy = FleetSortKey::Year;
+	}
+	else if (sortBy == "SEATS") {
+		query.SortBy = FleetSortKey::Seats;
+	}
+	else if (sortBy != ANYVALUE) {
+		return std::nullopt;
+	}
+	return query;
+}
+
+void System::SearchContractsMenu() const {
+	int chosenSearchOption = DisplayMenuAndGetChoice(ContractSearchMenuOptions);
+
+	std::vector<std::function<void()>> actions = {
+		[]() { /* Do nothing */ },
+		[&]() {	ShowCustomerContracts(); },
+		[&]() {	ShowCarContracts(); },
+		[&]() {	ShowContractsDueInPeriod(); }
+	};
+
+	if (chosenSearchOption >= 0 && static_cast<size_t>(chosenSearchOption) < actions.size()) {
+		actions[chosenSearchOption]();
+	}
+}
+
+void System::ShowCustomerContracts() const {
+	ConsoleController::DisplayCustomers(output);
+
+	ConsoleController::PrintPromptMessage(output, "customer", "phone number or e-mail");
+	input.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+	std::string phoneOrEmail;
+	try {
+		phoneOrEmail = GetValidToken([](const std::string& token) { return Repository::FindCustomer(token).has_value() || !Repository::FindCustomerContracts(token).empty(); }, "Customer");
+	}
+	catch (const std::runtime_error&) {
+		return;
+	}
+
+	StorageVector contracts = Repository::GetContracts(Repository::FindCustomerContracts(phoneOrEmail));
+	ConsoleController::ClearConsole();
+	ShowPages([&](size_t page) { return ConsoleController::DisplayListing(output, "Rental history", contracts, page); });
+}
+
+void System::ShowCarContracts() const {
+	ConsoleController::DisplayActiveContracts(output);
 
-	// Choosing car phase
 	ConsoleController::PrintPromptMessage(output, "car", "licence plate");
 	input.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
 	std::string licencePlate;
-	Properties foundProps;
 	try {
-		foundProps = GetValidRecord(ConcatPaths(SOURCEFILES, AVAILABLECARS), licencePlate, "Car");
+		licencePlate = GetValidToken([](const std::string& token) { return Repository::GetCarStatus(token).has_value() || !Repository::FindCarContracts(token).empty(); }, "Car");
 	}
-	catch (std::runtime_error) {
+	catch (const std::runtime_error&) {
 		return;
 	}
 
-	Car rentedCar(foundProps);
-	ClearAndDisplay([&]() { ConsoleController::DisplayCustomers(output); });
+	StorageVector contracts = Repository::GetContracts(Repository::FindCarContracts(licencePlate));
+	ConsoleController::ClearConsole();
+	ShowPages([&](size_t page) { return ConsoleController::DisplayListing(output, "Rentals of " + licencePlate, contracts, page); });
+}
 
+void System::ShowContractsDueInPeriod() const {
+	ConsoleController::DisplayAddingMessage(output, PERIODCOLUMNSNAMES);
 
-	// Choosing customer phase
-	ConsoleController::PrintPromptMessage(output, "customer", "phone number");
-	std::string phoneNumber;
+	const std::vector<int> mins = { MINSEARCHEDYEAR, 1, 1 };
+	const std::vector<int> maxes = { MAXSEARCHEDYEAR, 12, 31 };
+	std::vector<int> dateProps;
+	for (size_t i = 0; i < 2 * mins.size(); ++i) {
+		int dateProp = ConsoleController::GetIntInput(output, input, mins[i % mins.size()], maxes[i % maxes.size()]);
+		if (dateProp == -1) {
+			return;
+		}
+		dateProps.push_back(dateProp);
+	}
+
+	// The whole last day belongs to the period
+	std::optional<std::chrono::system_clock::time_point> from = MakeLocalTimePoint(dateProps[0], dateProps[1], dateProps[2], 0, 0);
+	std::optional<std::chrono::system_clock::time_point> to = MakeLocalTimePoint(dateProps[3], dateProps[4], dateProps[5] + 1, 0, 0);
+	if (!from || !to) {
+		return;
+	}
+
+	StorageVector contracts = Repository::GetContracts(Repository::FindContractsDueBetween(*from, *to));
+	ConsoleController::ClearConsole();
+	ShowPages([&](size_t page) { return ConsoleController::DisplayListing(output, "Contracts due in the period", contracts, page); });
+}
+
+void System::CreateNewContract() const {
+	ConsoleController::DisplayCars(output,CarStatus::Available);
+
+	// Choosing car phase
+	ConsoleController::PrintPromptMessage(output, "car", "licence plate");
+	input.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+	std::string licencePlate;
 	try {
-		foundProps = GetValidRecord(ConcatPaths(SOURCEFILES, CUSTOMERS), phoneNumber, "Customer");
+		licencePlate = GetValidToken([](const std::string& token) { return Repository::FindCar(CarStatus::Available, token).has_value(); }, "Car");
 	}
 	catch (std::runtime_error) {
 		return;
 	}
 
-	Customer rentingCustomer(foundProps);
+	Car rentedCar = *Repository::FindCar(CarStatus::Available, licencePlate);
+
+	// Choosing customer phase
+	std::optional<Customer> rentingCustomer = ChooseCustomer();
+	if (!rentingCustomer) {
+		return;
+	}
 
 	ConsoleController::ClearConsole();
 
@@ -287,64 +604,161 @@ void System::CreateNewContract() const {
 		return;
 	}
 
-	std::chrono::system_clock::time_point dueDate = CreateManualTimePoint(dateProps[0], dateProps[1], dateProps[2], dateProps[3], dateProps[4]);
+	std::optional<std::chrono::system_clock::time_point> dueDate = MakeLocalTimePoint(dateProps[0], dateProps[1], dateProps[2], dateProps[3], dateProps[4]);
+	if (!dueDate) {
+		ShowFailure(INVALIDDATEMESSAGE);
+		return;
+	}
+
+	// The car is rented out by creating the contract, it can still be reserved by someone else before the due date
+	std::chrono::system_clock::time_point now = std::chrono::system_clock::now();
+	if (*dueDate <= now) {
+		ShowFailure(PASTDUEDATEMESSAGE);
+		return;
+	}
+	if (!Repository::IsCarFree(licencePlate, now, *dueDate)) {
+		ShowFailure(BOOKEDCARMESSAGE);
+		return;
+	}
+	ContractId id = Repository::CreateContract(*rentingCustomer, rentedCar, now, *dueDate);
+	if (id != 0) {
+		Audit(AuditAction::CreateContract, licencePlate, id);
+	}
+}
+
+void System::CreateReservation() const {
+	// Choosing period phase
+	std::vector<int> startProps = GetContractProperties(RESERVATIONSTARTMESSAGE);
+	if (startProps.size() == 0) {
+		return;
+	}
+	ConsoleController::ClearConsole();
+	std::vector<int> endProps = GetContractProperties(RESERVATIONENDMESSAGE);
+	if (endProps.size() == 0) {
+		return;
+	}
+	std::optional<std::chrono::system_clock::time_point> start = MakeLocalTimePoint(startProps[0], startProps[1], startProps[2], startProps[3], startProps[4]);
+	std::optional<std::chrono::system_clock::time_point> end = MakeLocalTimePoint(endProps[0], endProps[1], endProps[2], endProps[3], endProps[4]);
+	if (!start || !end) {
+		ShowFailure(INVALIDDATEMESSAGE);
+		return;
+	}
+	if (*end <= *start) {
+		ShowFailure(INVALIDPERIODMESSAGE);
+		return;
+	}
 
-	FileWriter::CreateNewContract(rentingCustomer, rentedCar, dueDate);
+	// Choosing car phase
+	StorageVector freeCars = Repository::FindFreeCars(*start, *end);
+	ClearAndDisplay([&]() { ConsoleController::DisplayListing(output, "Cars free in the period", freeCars); });
+	ConsoleController::PrintPromptMessage(output, "car", "licence plate");
+	input.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+	std::string licencePlate;
+	try {
+		licencePlate = GetValidToken([&](const std::string& token) {
+			return std::any_of(freeCars.begin() + 1, freeCars.end(), [&](const Properties& car) { return car[LICENCEPLATEPOSITION] == token; });
+			}, "Car");
+	}
+	catch (const std::runtime_error&) {
+		return;
+	}
+	Car reservedCar = *Repository::FindCar(*Repository::GetCarStatus(licencePlate), licencePlate);
 
+	// Choosing customer phase
+	std::optional<Customer> customer = ChooseCustomer();
+	if (!customer) {
+		return;
+	}
 	ConsoleController::ClearConsole();
 
-	// This step has to be last in case the user cancels the creation somewhere in the process.
-	FileWriter::DeleteRecordInFile(ConcatPaths(SOURCEFILES,AVAILABLECARS), licencePlate);
-	FileWriter::AddCar(rentedCar,CarStatus::Rented);
+	ContractId id = Repository::CreateContract(*customer, reservedCar, *start, *end);
+	if (id == 0) {
+		ShowFailure(BOOKEDCARMESSAGE);
+		return;
+	}
+	Audit(AuditAction::CreateReservation, licencePlate, id);
+}
+
+std::optional<Customer> System::ChooseCustomer() const {
+	ClearAndDisplay([&]() { ConsoleController::DisplayCustomers(output); });
+
+	ConsoleController::PrintPromptMessage(output, "customer", "phone number or e-mail");
+	std::string phoneNumber;
+	try {
+		phoneNumber = GetValidToken([](const std::string& token) { return Repository::FindCustomer(token).has_value(); }, "Customer");
+	}
+	catch (const std::runtime_error&) {
+		return std::nullopt;
+	}
+	return Repository::FindCustomer(phoneNumber);
+}
+
+void System::ShowFailure(const char* message) const {
+	ConsoleController::PrintMessage(output, message);
+	ConsoleController::PrintMessage(output, BACKOPTIONLINE);
+	ConsoleController::GetIntInput(output, input, 0, numOfChoisesInDisplay);
 }
 
 void System::ArchiveContract() const {
-	StorageVector contracts = FileReader::GetActiveContracs();
 	ConsoleController::DisplayActiveContracts(output);
 
 	// Choosing contract phase
-	ConsoleController::PrintPromptMessage(output, "contract", "name");
+	ConsoleController::PrintPromptMessage(output, "contract", "ID");
 	input.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+	std::string token;
+	try {
+		token = GetValidToken([](const std::string& token) { return FindContractId(token, ContractState::Active) != 0; }, "Contract");
+	}
+	catch (const std::runtime_error&) {
+		return;
+	}
+
+	ContractId id = FindContractId(token, ContractState::Active);
+	std::optional<ContractRecord> contract = Repository::FindContract(id);
+	if (Repository::ArchiveContract(id)) {
+		Audit(AuditAction::ArchiveContract, contract ? contract->GetLicencePlate() : std::string_view(), id);
+	}
+}
 
-	std::string name = ConsoleController::GetStringInput(input);
-	bool found = false;
+void System::ShowPages(const std::function<size_t(size_t)>& display, const std::function<void(int)>& chooseRecord) const {
+	size_t page = 0;
+	while (true) {
+		size_t pageCount = display(page);
+		page = std::min(page, pageCount - 1);
+		ConsoleController::PrintMessage(output, chooseRecord ? SHOWCONTRACTMESSAGE : PAGEMESSAGE);
 
-	while (!found) {
-		if (name == "CANCEL") {
+		std::string token;
+		int number = 0;
+		if (!(input >> token) || token == "CANCEL" || token == "0") {
 			return;
 		}
-
-		for (const auto& innerVec : contracts) {
-			if (!innerVec.empty() && innerVec[0] == name) {
-				found = true;
-				break;
-			}
+		if (token == "N") {
+			page = std::min(page + 1, pageCount - 1);
 		}
-
-		if (!found) {
-			ConsoleController::PrintIncorrectMessage(output, "Contract");
-			name = ConsoleController::GetStringInput(input);
+		else if (token == "P") {
+			page = page == 0 ? 0 : page - 1;
 		}
+		else if (token.starts_with('J') && TryParseNumber(std::string_view(token).substr(1), number) && number > 0) {
+			page = std::min(static_cast<size_t>(number - 1), pageCount - 1);
+		}
+		else if (chooseRecord && TryParseNumber(token, number)) {
+			ConsoleController::ClearConsole();
+			chooseRecord(number);
+		}
+		ConsoleController::ClearConsole();
 	}
+}
 
-
-	// Get the licence plate
-	std::stringstream ss(name);
-	std::string token;
-	size_t indexOfPlate = 2;
-	for (size_t i = 0; i < indexOfPlate; ++i) {
-		std::getline(ss, token, '_');
-	}
-
-	std::string licencePlate = token;
-	Properties foundProps;
-	foundProps = FileReader::FindRecordByToken(ConcatPaths(SOURCEFILES, RENTEDCARS), licencePlate);
-	Car rentedCar(foundProps);
-
-	FileWriter::DeleteRecordInFile(ConcatPaths(SOURCEFILES,RENTEDCARS), licencePlate);
-	FileWriter::AddCar(rentedCar,CarStatus::Available);
-
-	FileWriter::MoveFileToFolder(ConcatPaths(SOURCEFILES, ACTIVECONTRACTS), ConcatPaths(SOURCEFILES,ARCHIVEDCONTRACTS), name + ".txt");
+void System::ShowContracts(ContractState state) const {
+	ShowPages([&](size_t page) {
+		return state == ContractState::Active ? ConsoleController::DisplayActiveContracts(output, page) : ConsoleController::DisplayArchivedContracts(output, page);
+		}, [&](int choice) {
+			std::optional<ContractRecord> contract = choice > 0 ? Repository::FindContract(static_cast<ContractId>(choice)) : std::nullopt;
+			if (contract && contract->GetState() == state) {
+				ConsoleController::DisplayContract(output, static_cast<ContractId>(choice));
+				ConsoleController::GetIntInput(output, input, 0, numOfChoisesInDisplay);
+			}
+		});
 }
 
 void System::MoveACar() const {
@@ -353,88 +767,35 @@ void System::MoveACar() const {
 	// Choose from which file to move the car
 	ConsoleController::PrintMessage(output, "Choose from where to move the car: ");
 	int fromOption = ConsoleController::GetIntInput(output, input, 0, MovingCarMenuOptions.size());
-	if (fromOption == -1) { return; }
-	std::filesystem::path fromPath;
-
-	ConsoleController::ClearConsole();
+	if (fromOption == -1 || fromOption == 0) { return; }
 
-	std::vector<std::function<void()>> fromActions = {
-		[&]() { }, // Case 0
-		[&]() { ConsoleController::DisplayCars(output,CarStatus::Available); fromPath = ConcatPaths(SOURCEFILES, AVAILABLECARS); },
-		[&]() { ConsoleController::DisplayCars(output,CarStatus::Rented); fromPath = ConcatPaths(SOURCEFILES, RENTEDCARS); },
-		[&]() { ConsoleController::DisplayCars(output,CarStatus::Serviced); fromPath = ConcatPaths(SOURCEFILES, SERVICEDCARS); },
-		[&]() { ConsoleController::DisplayCars(output,CarStatus::PermanentlyUnavailable); fromPath = ConcatPaths(SOURCEFILES, PERMANENTLYUNAVAILABLECARS); }
-	};
+	// The statuses in the same order as MovingCarMenuOptions
+	const std::vector<CarStatus> statuses = { CarStatus::Available, CarStatus::Rented, CarStatus::Serviced, CarStatus::PermanentlyUnavailable };
+	CarStatus fromStatus = statuses[fromOption - 1];
 
-	if (fromOption == 0) return;
-	if (fromOption >= 0 && fromOption < fromActions.size()) {
-		fromActions[fromOption]();
-	}
+	ClearAndDisplay([&]() { ConsoleController::DisplayCars(output, fromStatus); });
 
 	// Choosing car phase
 	ConsoleController::PrintPromptMessage(output, "car", "licence plate");
 	input.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
 	std::string licencePlate;
-	Properties foundProps;
 	try {
-		foundProps = GetValidRecord(fromPath, licencePlate, "Car");
+		licencePlate = GetValidToken([&](const std::string& token) { return Repository::FindCar(fromStatus, token).has_value(); }, "Car");
 	}
 	catch (std::runtime_error) {
 		return;
 	}
 
-	Car chosenCar(foundProps);
-
 	ClearAndDisplay([&]() { ConsoleController::DisplayMenu(output, MovingCarMenuOptions, false); });
 	
 	// Choose the destination file
 	ConsoleController::PrintMessage(output, "Choose where to move the car: ");
 	int toOption = ConsoleController::GetIntInput(output, input, 0, MovingCarMenuOptions.size());
+	if (toOption == -1 || toOption == 0) { return; }
 
-	std::vector<std::function<void()>> toActions = {
-		[&]() { return; }, // Case 0
-		[&]() { FileWriter::AddCar(chosenCar,CarStatus::Available); },
-		[&]() { FileWriter::AddCar(chosenCar,CarStatus::Rented); },
-		[&]() { FileWriter::AddCar(chosenCar,CarStatus::Serviced); },
-		[&]() { FileWriter::AddCar(chosenCar,CarStatus::PermanentlyUnavailable); }
-	};
-
-	if (toOption == 0) return;
-	if (toOption >= 0 && toOption < toActions.size()) {
-		toActions[toOption]();
+	if (Repository::MoveCar(licencePlate, fromStatus, statuses[toOption - 1])) {
+		Audit(AuditAction::MoveCar, licencePlate, 0, static_cast<std::uint8_t>(fromStatus), static_cast<std::uint8_t>(statuses[toOption - 1]));
 	}
-
-	// This step has to be last in case the user cancels the creation somewhere in the process.
-	FileWriter::DeleteRecordInFile(fromPath, licencePlate);
-
-}
-
-int System::CheckContractDates() const {
-	StorageVector activeContracts = FileReader::GetActiveContracs();
-	int counterOfDelayedContracts = 0;
-
-	for (const auto& contract : activeContracts) {
-		std::string contractName = contract[0];
-
-		// Find the position of the first underscore after name_plate_
-		size_t first_underscore = contractName.find('_', contractName.find('_') + 1);
-
-		// Extract the year, month, day, hour, and minute substrings
-		int year, month, day, hour, minute;
-		std::stringstream ss(contractName.substr(first_underscore + 1));
-		char delim;
-
-		ss >> year >> delim >> month >> delim >> day >> delim >> hour >> delim >> minute;
-
-		std::chrono::system_clock::time_point dueDate = CreateManualTimePoint(year, month, day, hour, minute);
-		std::chrono::system_clock::time_point now = std::chrono::system_clock::now();
-
-		if (dueDate < now) {
-			counterOfDelayedContracts++;
-		}
-	}
-
-	return counterOfDelayedContracts;
 }
 
 int System::CalculateRentDurationHours(const std::chrono::system_clock::time_point& currentTime, const std::chrono::system_clock::time_point& returnTime) const {
@@ -442,24 +803,6 @@ int System::CalculateRentDurationHours(const std::chrono::system_clock::time_poi
 	return duration.count();
 }
 
-std::chrono::system_clock::time_point System::CreateManualTimePoint(int year, int month, int day, int hour, int min) const {
-	std::tm local_time = {};
-	local_time.tm_year = year - 1900;
-	local_time.tm_mon = month - 1;
-	local_time.tm_mday = day;
-	local_time.tm_hour = hour - 1;
-	local_time.tm_min = min;
-	local_time.tm_sec = 0;
-
-#ifdef _WIN32
-	__time64_t time = _mkgmtime64(&local_time);
-#else
-	std::time_t time = std::mktime(&local_time);
-#endif
-
-	return std::chrono::system_clock::from_time_t(time);
-}
-
 void System::ClearAndDisplay(const std::function<void()>& displayFunction) const {
 	ConsoleController::ClearConsole();
 	displayFunction();
@@ -472,6 +815,18 @@ int System::DisplayMenuAndGetChoice(const std::vector<std::string>& options, boo
 	return choice;
 }
 
+ContractId System::FindContractId(const std::string& token, ContractState state) {
+	int id = 0;
+	if (!TryParseNumber(token, id) || id <= 0) {
+		return 0;
+	}
+	std::optional<ContractRecord> contract = Repository::FindContract(static_cast<ContractId>(id));
+	if (!contract || contract->GetState() != state) {
+		return 0;
+	}
+	return static_cast<ContractId>(id);
+}
+
 std::string System::GetUserInputOrCancel(std::istream& input) const{
 	std::string inputStr = ConsoleController::GetStringInput(input);
 	if (inputStr == "CANCEL") {
@@ -480,13 +835,30 @@ std::string System::GetUserInputOrCancel(std::istream& input) const{
 	return inputStr;
 }
 
-Properties System::GetValidRecord(const std::filesystem::path& path, std::string& searchedToken, const std::string& entityName) const{
+std::string System::GetValidToken(const std::function<bool(const std::string&)>& isValid, const std::string& entityName) const{
     while (true) {
-        searchedToken = GetUserInputOrCancel(input);
-        Properties record = FileReader::FindRecordByToken(path, searchedToken);
-        if (!record.empty()) {
-            return record;
+        std::string searchedToken = GetUserInputOrCancel(input);
+        if (isValid(searchedToken)) {
+            return searchedToken;
         }
         ConsoleController::PrintIncorrectMessage(output, entityName);
     }
 }
+
+void System::Audit(AuditAction action, std::string_view subject, ContractId contract, std::uint8_t from, std::uint8_t to) const {
+	AuditLog::Record(action, user.GetUsername(), subject, contract, from, to);
+}
+
+void System::SetActionObserver(ActionObserver observer) {
+	actionObserver = std::move(observer);
+}
+
+void System::TimeAction(const std::string& name, const std::function<void()>& action) const {
+	if (!actionObserver) {
+		action();
+		return;
+	}
+	auto start = std::chrono::steady_clock::now();
+	action();
+	actionObserver(name, std::chrono::steady_clock::now() - start);
+}
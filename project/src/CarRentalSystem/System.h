@@ -4,16 +4,29 @@
 #define _MAIN_H_
 
 #include "ConsoleController.h"
+#include "AuditLog.h"
 #include <functional>
 
 // Menu options for different user roles and operations
-const std::vector<std::string> MenuOptions = { "Cars", "Customers", "Show active contracts", "New contract", "End active contract" };
-const std::vector<std::string> AdminMenuOptions = { "Cars", "Customers", "Show active contracts", "New contract", "End active contract", "Add a user", "Show archived contracts" };
-const std::vector<std::string> CarMenuOptions = { "Show available cars", "Show rented cars", "Show cars in service", "Show permanently unavailable cars" };
-const std::vector<std::string> AdminCarMenuOptions = { "Show available cars", "Show rented cars", "Show cars in service", "Show permanently unavailable cars", "Add new car", "Move a car" };
+const std::vector<std::string> MenuOptions = { "Cars", "Customers", "Show active contracts", "New contract", "New reservation", "End active contract" };
+const std::vector<std::string> AdminMenuOptions = { "Cars", "Customers", "Show active contracts", "New contract", "New reservation", "End active contract", "Add a user", "Show archived contracts", "Reports" };
+const std::vector<std::string> CarMenuOptions = { "Show available cars", "Show rented cars", "Show cars in service", "Show permanently unavailable cars", "Search available cars" };
+const std::vector<std::string> AdminCarMenuOptions = { "Show available cars", "Show rented cars", "Show cars in service", "Show permanently unavailable cars", "Search available cars", "Add new car", "Move a car" };
 const std::vector<std::string> MovingCarMenuOptions = { "Available cars", "Rented cars", "Cars in service", "Permanently unavailable cars" };
 const std::vector<std::string> CarMenuAddingOptions = { "Add an available car", "Add a serviced car", "Add a rented car", "Add a permanently unavailable car" };
-const std::vector<std::string> CustomerMenuOptions = { "Show customers", "Add a customer" };
+const std::vector<std::string> CustomerMenuOptions = { "Show customers", "Add a customer", "Search contracts" };
+const std::vector<std::string> ContractSearchMenuOptions = { "Rental history of a customer", "Rentals of a car", "Contracts due in a period" };
+
+// The names of the measured actions (see SetActionObserver) in the order of the options of the menus, 0 is going back
+const std::vector<std::string> MenuActionNames = { "Exit", "CarsMenu", "CustomersMenu", "ActiveContracts", "NewContract", "NewReservation", "EndContract", "AddUser", "ArchivedContracts", "Reports" };
+const std::vector<std::string> CarMenuActionNames = { "Back", "ListCars", "ListCars", "ListCars", "ListCars", "SearchCars", "AddCar", "MoveCar" };
+constexpr char LOGINACTIONNAME[] = "LogIn";
+constexpr char MAINMENUACTIONNAME[] = "MainMenu";
+
+/**
+ * @brief Called with the name of every finished action of a session and the time it took (including reading its input).
+ */
+using ActionObserver = std::function<void(const std::string& action, std::chrono::steady_clock::duration duration)>;
 
 // Default message for unknown exceptions
 constexpr char UNKNOWNEXCEPTIONMESSAGE[] = "Unknown exception occurred!";
@@ -22,6 +35,23 @@ constexpr char UNKNOWNEXCEPTIONMESSAGE[] = "Unknown exception occurred!";
 constexpr int numOfChoisesInDisplay = 0;
 constexpr int MAXYEARSOFRENT = 2;
 
+constexpr char PAGEMESSAGE[] = "Type N for the next page, P for the previous page, J and a page number to jump to it (e.g. J3) or 0 to go back.";
+constexpr char SHOWCONTRACTMESSAGE[] = "Type the ID of a contract to show its text, N for the next page, P for the previous page or J and a page number to jump to it (e.g. J3).";
+constexpr char RESERVATIONSTARTMESSAGE[] = "When does the reservation start?";
+constexpr char RESERVATIONENDMESSAGE[] = "When does the reservation end?";
+constexpr char PERIODCOLUMNSNAMES[] = "FROM_YEAR FROM_MONTH FROM_DAY TO_YEAR TO_MONTH TO_DAY";
+constexpr char CARSEARCHCOLUMNSNAMES[] = "MAKE MODEL MOTORIZATION GEARBOX SEATS MIN_YEAR MAX_YEAR MIN_COST_PER_HOUR MAX_COST_PER_HOUR SORT_BY";
+constexpr char CARSEARCHHINT[] = "Type * for any value. Sort by COST_PER_HOUR, YEAR or SEATS, put - in front for the highest first.";
+constexpr char ANYVALUE[] = "*";
+constexpr int MINSEARCHEDYEAR = 1970;
+constexpr int MAXSEARCHEDYEAR = 9999;
+
+// The command line option of the batch mode and the results it reports
+constexpr char BATCHOPTION[] = "--batch";
+constexpr char BATCHOKMESSAGE[] = "OK";
+constexpr char BATCHERRORMESSAGE[] = "ERROR";
+constexpr char BATCHUSERNAME[] = "batch"; // The user the batch commands are audited as
+
 /**
  * @class System
  * @brief Manages the overall car rental system.
@@ -33,20 +63,61 @@ public:
      * @param output The output stream for displaying messages.
      * @param input The input stream for receiving user input.
      */
-    System(std::ostream& output, std::istream& input) : output(output), input(input), user({ "void", "void", "void" }) {}
+    System(std::ostream& output, std::istream& input) : output(output), input(input), user("void", "void", false) {}
 
     /**
-     * @brief Starts the system's main loop.
+     * @brief Loads the repository and starts the system's main loop.
      */
     void Run();
 
+    /**
+     * @brief Lets the user log in and runs the main loop until the user exits or the input ends.
+     * The repository has to be loaded already, for example by the server all the sessions share.
+     */
+    void RunSession();
+
     /**
      * @brief Handles user login.
      * @return True if login is successful, false otherwise.
      */
     bool LogIn();
 
+    /**
+     * @brief Runs the commands read from the input stream without any menus or clearing of the screen and reports the result
+     * of every command on one line. There is one command on a line, empty lines and lines starting with # are skipped:
+     * rent <licence plate> <phone or e-mail> <YYYY-MM-DDTHH:MM>, reserve <licence plate> <phone or e-mail> <start YYYY-MM-DDTHH:MM> <end YYYY-MM-DDTHH:MM>,
+     * return <contract ID>, move <licence plate> <available|rented|serviced|unavailable>
+     * @return The number of failed commands.
+     */
+    size_t RunBatch();
+
+    /**
+     * @brief Measures the actions of the sessions, for example of the replayed ones.
+     * @param observer Called after every action, an empty observer stops the measuring.
+     */
+    void SetActionObserver(ActionObserver observer);
+
 private:
+    /**
+     * @brief Runs an action and reports its duration to the action observer if there is one.
+     * @param name The name of the action.
+     * @param action The action.
+     */
+    void TimeAction(const std::string& name, const std::function<void()>& action) const;
+
+    /**
+     * @brief Runs one command of the batch mode.
+     * @param command The words of the command.
+     * @param message The result of the command (e.g. the ID of the created contract) or the reason it failed.
+     * @return True if the command succeeded.
+     */
+    bool RunBatchCommand(const std::vector<std::string>& command, std::string& message) const;
+
+    /**
+     * @brief Parses the due date of a contract in the batch mode (YYYY-MM-DDTHH:MM in local time).
+     * @return The due date, std::nullopt if it is not a valid date.
+     */
+    static std::optional<std::chrono::system_clock::time_point> ParseBatchDueDate(std::string_view text);
 
 
     /**
@@ -86,34 +157,108 @@ private:
      */
     void CreateNewContract() const;
 
+    /**
+     * @brief Creates a contract for a period in the future, the user chooses one of the cars free in the period.
+     */
+    void CreateReservation() const;
+
+    /**
+     * @brief Lets the user choose a customer from the customer list.
+     * @return The customer, std::nullopt if the user cancelled the choice.
+     */
+    std::optional<Customer> ChooseCustomer() const;
+
+    /**
+     * @brief Shows a message about a failed operation and waits until the user goes back.
+     * @param message The message.
+     */
+    void ShowFailure(const char* message) const;
+
+    /**
+     * @brief Records an action of the logged in user in the audit log.
+     * @param action The action.
+     * @param subject The licence plate, customer or user the action concerns.
+     * @param contract The contract the action concerns, 0 if none.
+     * @param from The car status before a move, NOAUDITSTATUS if none.
+     * @param to The car status after a move or of an added car, NOAUDITSTATUS if none.
+     */
+    void Audit(AuditAction action, std::string_view subject, ContractId contract = 0, std::uint8_t from = NOAUDITSTATUS, std::uint8_t to = NOAUDITSTATUS) const;
+
     /**
      * @brief Archives an existing contract.
      */
     void ArchiveContract() const;
 
     /**
-     * @brief Moves a car from one status to another (e.g., from available to rented).
+     * @brief Displays the contracts with the given state and the text of the contracts the user chooses.
+     * @param state The state of the displayed contracts.
      */
-    void MoveACar() const;
+    void ShowContracts(ContractState state) const;
+
+    /**
+     * @brief Shows a listing page by page until the user goes back (0 or CANCEL).
+     * @param display Displays the given page of the listing and returns the number of pages.
+     * @param chooseRecord Called with any other number the user types (e.g. the ID of a contract), nullptr if only the pages can be chosen.
+     */
+    void ShowPages(const std::function<size_t(size_t)>& display, const std::function<void(int)>& chooseRecord = nullptr) const;
+
+    /**
+     * @brief Displays the reports of the rental, all computed from one read view of the repository.
+     */
+    void ShowReports() const;
+
+    /**
+     * @brief Searches the available cars by the attributes the user enters and shows the found cars.
+     */
+    void SearchCars() const;
+
+    /**
+     * @brief Creates a query from the conditions the user entered for the car search.
+     * @param props The entered conditions in the order of CARSEARCHCOLUMNSNAMES.
+     * @return The query, std::nullopt if a number or the order is invalid.
+     */
+    static std::optional<FleetQuery> CreateCarQuery(const Properties& props);
+
+    /**
+     * @brief Displays the menu of contract searches and runs the chosen one.
+     */
+    void SearchContractsMenu() const;
 
     /**
-     * @brief Checks and returns the number of contracts that are overdue.
-     * @return The number of overdue contracts.
+     * @brief Displays the rental history of the customer the user chooses.
      */
-    int CheckContractDates() const;
+    void ShowCustomerContracts() const;
 
     /**
-     * @brief Prompts the user to enter car properties and returns them.
-     * @param namesOfProps The names of the properties to be entered.
+     * @brief Displays all the rentals of the car the user chooses.
+     */
+    void ShowCarContracts() const;
+
+    /**
+     * @brief Displays the contracts due in the period the user enters.
+     */
+    void ShowContractsDueInPeriod() const;
+
+    /**
+     * @brief Moves a car from one status to another (e.g., from available to rented).
+     */
+    void MoveACar() const;
+
+    /**
+     * @brief Prompts the user to enter the properties of a record and returns them.
+     * @param namesOfProps The names of the properties to be entered separated by spaces.
+     * @param numberOfProps The number of the properties to be entered.
+     * @param hint An explanation of the properties displayed under their names, nullptr for none.
      * @return The entered properties.
      */
-    Properties GetPropsFromInput(const char* namesOfProps) const;
+    Properties GetPropsFromInput(const char* namesOfProps, size_t numberOfProps, const char* hint = nullptr) const;
 
     /**
      * @brief Prompts the user to enter contract properties and returns them.
+     * @param hint An explanation of the entered date displayed under the names of the properties, nullptr for none.
      * @return A vector containing the entered contract properties.
      */
-    std::vector<int> GetContractProperties() const;
+    std::vector<int> GetContractProperties(const char* hint = nullptr) const;
 
     /**
      * @brief Counts the number of words in a string.
@@ -144,17 +289,6 @@ private:
      */
     int DisplayMenuAndGetChoice(const std::vector<std::string>& options, bool showDelayedContracts = false, int delayedContractsNumber = 0) const;
 
-    /**
-     * @brief Creates a time point based on manual input of year, month, day, hour, and minute.
-     * @param year The year.
-     * @param month The month.
-     * @param day The day.
-     * @param hour The hour.
-     * @param min The minute.
-     * @return The created time point.
-     */
-    std::chrono::system_clock::time_point CreateManualTimePoint(int year, int month, int day, int hour, int min) const;
-
     /**
      * @brief Gets a correct input or throws a runtime error
      * @param input the input stream
@@ -163,17 +297,25 @@ private:
     std::string GetUserInputOrCancel(std::istream& input) const;
     
     /**
-     * @brief Gets a valid record or throws an error
-     * @param path the path of the file we search in
-     * @param searchedToken the property of the record we search it by
+     * @brief Gets a token identifying an existing record (e.g. a licence plate) or throws an error
+     * @param isValid the function deciding if there is a record with the given token
      * @param entityName the type of the record (car, customer, etc. )
-     * @return the found properties
+     * @return the valid token
+     */
+    std::string GetValidToken(const std::function<bool(const std::string&)>& isValid, const std::string& entityName) const;
+
+    /**
+     * @brief Converts a token typed by the user to the identifier of a contract with the given state.
+     * @param token The typed token.
+     * @param state The state the contract has to be in.
+     * @return The identifier, 0 if there is no such contract.
      */
-    Properties GetValidRecord(const std::filesystem::path& path, std::string& searchedToken, const std::string& entityName) const;
+    static ContractId FindContractId(const std::string& token, ContractState state);
 
     User user;
     std::ostream& output; 
     std::istream& input; 
+    ActionObserver actionObserver;
 };
 
 #endif // !_MAIN_H_